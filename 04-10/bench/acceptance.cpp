@@ -0,0 +1,64 @@
+// Per-sample cost of the Metropolis acceptance test, exp() against the threshold table.
+// Build from 04-10/: make acceptance_bench
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include "metropolis.h"
+#include "random.h"
+
+#define SAMPLES (1 << 22)
+#define REPETITIONS 5
+
+static volatile long long sink;
+
+// Best of REPETITIONS passes over the same deltas, in nanoseconds per sample. The decisions of the
+// first pass are recorded by an untimed pass over the same random stream.
+double time_acceptance(AcceptanceMode mode, double t, const std::vector<long long> &deltas, std::vector<bool> *decisions) {
+    MetropolisCriterion metropolis(mode, t);
+    double best = -1;
+
+    Random first(Random::DEFAULT_SEED, 0);
+    decisions->resize(deltas.size());
+    for (size_t k = 0; k < deltas.size(); k++)
+        (*decisions)[k] = metropolis.accept(deltas[k], &first);
+
+    for (int r = 0; r < REPETITIONS; r++) {
+        Random rng(Random::DEFAULT_SEED, r);
+        long long count = 0;
+
+        auto start = std::chrono::steady_clock::now();
+        for (long long delta : deltas)
+            count += metropolis.accept(delta, &rng);
+        auto end = std::chrono::steady_clock::now();
+
+        double ns = std::chrono::duration<double, std::nano>(end - start).count() / deltas.size();
+        if (best < 0 || ns < best) best = ns;
+        sink = count;
+    }
+
+    return best;
+}
+
+int main() {
+    std::cout << "temperature,exp_ns,table_ns,speedup,accepted,same_decisions" << std::endl;
+
+    for (double t : { 1.0, 10.0, 100.0, 1000.0, 100000.0 }) {
+        // mostly worsening movements a few temperatures deep, like an annealing chain near equilibrium
+        Random rng(t);
+        std::vector<long long> deltas(SAMPLES);
+        long long span = (long long) (5 * t) + 1;
+        for (long long &delta : deltas)
+            delta = (long long) rng.uniform_int(span) - 4 * span / 5;
+
+        std::vector<bool> decisions_exp, decisions_table;
+        double exp_ns = time_acceptance(AcceptanceMode::EXP, t, deltas, &decisions_exp);
+        double table_ns = time_acceptance(AcceptanceMode::TABLE, t, deltas, &decisions_table);
+
+        long long accepted = std::count(decisions_exp.begin(), decisions_exp.end(), true);
+        std::cout << std::setprecision(6) << t << "," << exp_ns << "," << table_ns << ","
+                  << exp_ns / table_ns << "," << accepted << ","
+                  << (decisions_exp == decisions_table ? "yes" : "no") << std::endl;
+    }
+}
@@ -0,0 +1,163 @@
+// ns/op of the solver's hot primitives on every instance given, as CSV on stdout.
+// Build from 04-10/: make primitives_bench
+// Usage: primitives_bench [instance files or directories...]   (default: tests/instances-*)
+#include <iostream>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <functional>
+#include <algorithm>
+#include "knapsack.h"
+
+#define TARGET_SECONDS 0.05  // per measurement
+#define REPETITIONS 3
+#define BATCH 1024  // random inputs cycled through by each measurement
+
+static volatile long long sink;
+
+// Calls f(iterations) with a growing count until one call lasts TARGET_SECONDS,
+// then reports the best time per iteration over REPETITIONS calls.
+void measure(const std::string &instance, int n, const std::string &operation, const std::function<void(long long)> &f) {
+    auto seconds = [&](long long iterations) {
+        auto start = std::chrono::steady_clock::now();
+        f(iterations);
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    long long iterations = 1;
+    while (seconds(iterations) < TARGET_SECONDS && iterations < (1LL << 40))
+        iterations *= 4;
+
+    double best = -1;
+    for (int r = 0; r < REPETITIONS; r++) {
+        double ns = seconds(iterations) * 1e9 / iterations;
+        if (best < 0 || ns < best) best = ns;
+    }
+
+    std::cout << instance << "," << n << "," << operation << "," << best << "," << iterations << std::endl;
+}
+
+template <class MovementClass>
+void measure_movement(const std::string &instance, KnapsackEvaluator *evl, KnapsackSolution *s, const std::string &name, Random *rng) {
+    KnapsackMovementGenerator<MovementClass> mg(evl, evl->n);
+    std::vector<MovementClass> movements;
+    for (int k = 0; k < BATCH; k++)
+        movements.push_back(mg.get_random(rng));
+
+    measure(instance, evl->n, name + "::delta", [&](long long iterations) {
+        long long x = 0;
+        for (long long k = 0; k < iterations; k++)
+            x += movements[k % BATCH].delta(s);
+        sink = x;
+    });
+
+    measure(instance, evl->n, name + "::move+undo", [&](long long iterations) {
+        for (long long k = 0; k < iterations; k++) {
+            movements[k % BATCH].move(s);
+            movements[k % BATCH].undo(s);
+        }
+        sink = s->w;
+    });
+
+    measure(instance, evl->n, name + "Generator::get_random", [&](long long iterations) {
+        long long x = 0;
+        for (long long k = 0; k < iterations; k++)
+            x += mg.get_random(rng).j;
+        sink = x;
+    });
+
+    measure(instance, evl->n, name + "Generator::next", [&](long long iterations) {
+        long long x = 0;
+        mg.reset();
+        for (long long k = 0; k < iterations; k++) {
+            if (!mg.has_next()) mg.reset();
+            x += mg.next().j;
+        }
+        sink = x;
+    });
+}
+
+void bench_instance(const std::string &path) {
+    KnapsackInstance *instance = KnapsackInstance::load(path);
+    KnapsackEvaluator evl(instance);
+    std::string name = std::filesystem::path(path).filename().string();
+    int n = evl.n;
+    Random rng(Random::DEFAULT_SEED);
+
+    Budget unlimited(Budget::UNLIMITED);
+    KnapsackSolution *s = cm_knapsack_greedy(&evl, &unlimited);
+    evl.get_evaluation(s);
+
+    std::vector<int> items;
+    for (int k = 0; k < BATCH; k++)
+        items.push_back(rng.uniform_int(n));
+
+    measure(name, n, "KnapsackSolution::clone", [&](long long iterations) {
+        for (long long k = 0; k < iterations; k++)
+            delete s->clone();
+    });
+
+    // on a copy, so that the movements below start from the greedy solution
+    KnapsackSolution *flipped = (KnapsackSolution*) s->clone();
+    measure(name, n, "KnapsackSolution::flip", [&](long long iterations) {
+        for (long long k = 0; k < iterations; k++)
+            flipped->flip(items[k % BATCH], &evl);
+        sink = flipped->w;
+    });
+    delete flipped;
+
+    measure(name, n, "KnapsackEvaluator::evaluate", [&](long long iterations) {
+        long long x = 0;
+        for (long long k = 0; k < iterations; k++)
+            x += evl.evaluate(s);
+        sink = x;
+    });
+
+    measure_movement<Knapsack2FlipBitMovement>(name, &evl, s, "Knapsack2FlipBitMovement", &rng);
+    measure_movement<KnapsackIntervalFlipBitMovement>(name, &evl, s, "KnapsackIntervalFlipBitMovement", &rng);
+    measure_movement<KnapsackInversionMovement>(name, &evl, s, "KnapsackInversionMovement", &rng);
+
+    auto measure_constructive = [&](const std::string &operation, const std::function<KnapsackSolution*()> &construct) {
+        measure(name, n, operation, [&](long long iterations) {
+            for (long long k = 0; k < iterations; k++)
+                delete construct();
+        });
+    };
+    measure_constructive("cm_knapsack_greedy", [&]() { return cm_knapsack_greedy(&evl, &unlimited); });
+    measure_constructive("cm_knapsack_random", [&]() { return cm_knapsack_random(&evl, &unlimited, &rng); });
+    measure_constructive("cm_knapsack_greedy_randomized", [&]() { return cm_knapsack_greedy_randomized(&evl, 0.5, &unlimited, &rng); });
+
+    delete s;
+    delete instance;
+}
+
+int main(int argc, char **argv) {
+    std::vector<std::string> targets;
+    for (int i = 1; i < argc; i++)
+        targets.push_back(argv[i]);
+    if (targets.empty())
+        targets = { "tests/instances-low_dimensional", "tests/instances-large_scale" };
+
+    std::vector<std::string> paths;
+    for (const std::string &target : targets) {
+        if (std::filesystem::is_directory(target)) {
+            for (const auto &entry : std::filesystem::directory_iterator(target)) {
+                if (entry.is_regular_file())
+                    paths.push_back(entry.path().string());
+            }
+        } else {
+            paths.push_back(target);
+        }
+    }
+    std::sort(paths.begin(), paths.end());
+
+    std::cout << "instance,n,operation,ns_per_op,iterations" << std::endl;
+    for (const std::string &path : paths) {
+        try {
+            bench_instance(path);
+        } catch (const std::exception &e) {
+            std::cerr << "Skipping " << path << ": " << e.what() << std::endl;
+        }
+    }
+}
@@ -0,0 +1,96 @@
+#include "budget.h"
+#include "progress.h"
+#include <algorithm>
+
+static std::chrono::steady_clock::time_point deadline_after(std::chrono::steady_clock::time_point start, double seconds) {
+    auto max = std::chrono::steady_clock::time_point::max();
+    if (!(seconds < std::chrono::duration<double>(max - start).count()))
+        return max;
+    return start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds));
+}
+
+Budget::Budget(double seconds, long long max_evaluations)
+    : Budget(nullptr, seconds, max_evaluations) {}
+
+Budget::Budget(Budget *parent, double seconds, long long max_evaluations)
+    : evaluations(0), pending(0), exhausted(false)
+{
+    this->parent = parent;
+    this->start = clock::now();
+    this->last_check = this->start;
+    this->deadline = deadline_after(this->start, seconds);
+    if (parent != nullptr)
+        this->deadline = std::min(this->deadline, parent->deadline);
+    this->max_evaluations = max_evaluations;
+    this->calls = 0;
+    this->stride = 1;
+    this->recorder = (parent != nullptr) ? parent->recorder : nullptr;
+    this->allowance = this->evaluations_left();
+}
+
+Budget::~Budget() {
+    this->push_pending();
+}
+
+void Budget::push_pending() {
+    long long n = this->pending.load(std::memory_order_relaxed);
+    if (n == 0) return;
+
+    this->pending.store(0, std::memory_order_relaxed);
+    for (Budget *b = this; b != nullptr; b = b->parent)
+        b->evaluations.fetch_add(n, std::memory_order_relaxed);
+}
+
+long long Budget::evaluations_left() const {
+    long long left = std::numeric_limits<long long>::max();
+    for (const Budget *b = this; b != nullptr; b = b->parent) {
+        if (b->max_evaluations >= 0)
+            left = std::min(left, b->max_evaluations - b->evaluations.load(std::memory_order_relaxed));
+    }
+    return left;
+}
+
+bool Budget::expired_now() {
+    this->push_pending();
+    this->allowance = this->evaluations_left();
+
+    clock::time_point now = clock::now();
+    if (now >= this->deadline || this->allowance <= 0 || (this->parent != nullptr && this->parent->exhausted.load())) {
+        this->exhausted.store(true, std::memory_order_relaxed);
+        return true;
+    }
+
+    double interval = std::chrono::duration<double>(now - this->last_check).count();
+    if (interval < CHECK_INTERVAL / 2)
+        this->stride = std::min(this->stride * 2, MAX_STRIDE);
+    else if (interval > CHECK_INTERVAL * 2)
+        this->stride = std::max(this->stride / 2, 1u);
+
+    this->calls = 0;
+    this->last_check = now;
+    return false;
+}
+
+double Budget::elapsed() const {
+    return std::chrono::duration<double>(clock::now() - this->start).count();
+}
+
+double Budget::remaining() const {
+    if (this->deadline == clock::time_point::max()) return UNLIMITED;
+    return std::max(0.0, std::chrono::duration<double>(this->deadline - clock::now()).count());
+}
+
+long long Budget::get_evaluations() const {
+    return this->evaluations.load(std::memory_order_relaxed) + this->pending.load(std::memory_order_relaxed);
+}
+
+void Budget::set_recorder(ProgressRecorder *recorder) {
+    this->recorder = recorder;
+}
+
+void Budget::report(long long value) {
+    const Budget *root = this;
+    while (root->parent != nullptr)
+        root = root->parent;
+    this->recorder->record(root->elapsed(), root->get_evaluations(), value);
+}
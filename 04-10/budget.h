@@ -0,0 +1,48 @@
+#ifndef BUDGET_H
+#define BUDGET_H
+
+#include <chrono>
+#include <atomic>
+#include <limits>
+
+class ProgressRecorder;
+
+// Time and evaluation budget. expired() reads the clock every 'stride' calls, adapting the stride to about
+// CHECK_INTERVAL; a child ends with its parent, charges it too, and is used by a single thread.
+class Budget {
+private:
+    typedef std::chrono::steady_clock clock;
+    static constexpr double CHECK_INTERVAL = 0.0005;
+    static constexpr unsigned MAX_STRIDE = 1 << 16;
+    Budget *parent;
+    clock::time_point start, deadline, last_check;
+    long long max_evaluations;  // -1 for no limit
+    std::atomic<long long> evaluations;  // pushed by this budget and its children
+    std::atomic<long long> pending;  // charged and not pushed yet; only the owning thread writes it
+    long long allowance;  // evaluations that may be charged before the next clock read
+    std::atomic<bool> exhausted;
+    unsigned calls, stride;
+    ProgressRecorder *recorder;
+    void push_pending();
+    long long evaluations_left() const;  // over this budget and its ancestors, LLONG_MAX without limits
+    void report(long long value);
+public:
+    static constexpr double UNLIMITED = std::numeric_limits<double>::infinity();
+    Budget(double seconds, long long max_evaluations = -1);
+    Budget(Budget *parent, double seconds = UNLIMITED, long long max_evaluations = -1);
+    Budget(const Budget&) = delete;
+    Budget& operator=(const Budget&) = delete;
+    ~Budget();
+    inline bool expired();  // amortized check, cheap enough for the innermost loops
+    bool expired_now();  // always reads the clock
+    inline void charge(long long evaluations = 1);
+    double elapsed() const;
+    double remaining() const;
+    long long get_evaluations() const;
+    void set_recorder(ProgressRecorder *recorder);  // children created before the call keep their own
+    inline void improved(long long value);  // records value at the time and evaluations of the root budget
+};
+
+#include "budget.tpp"
+
+#endif // BUDGET_H
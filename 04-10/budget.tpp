@@ -0,0 +1,20 @@
+#include "budget.h"
+
+inline bool Budget::expired() {
+    if (this->exhausted.load(std::memory_order_relaxed)) return true;
+
+    if (++this->calls < this->stride && this->pending.load(std::memory_order_relaxed) < this->allowance)
+        return false;
+
+    return this->expired_now();
+}
+
+inline void Budget::charge(long long evaluations) {
+    // a plain load and store: no other thread writes pending
+    this->pending.store(this->pending.load(std::memory_order_relaxed) + evaluations, std::memory_order_relaxed);
+}
+
+inline void Budget::improved(long long value) {
+    if (this->recorder != nullptr)
+        this->report(value);
+}
@@ -0,0 +1,71 @@
+#include "configurations.h"
+
+const std::vector<std::string> ALGORITHMS = { "grasp", "sa", "pt", "hc", "rdm" };
+
+bool is_algorithm(const std::string &name) {
+    return std::find(ALGORITHMS.begin(), ALGORITHMS.end(), name) != ALGORITHMS.end();
+}
+
+KnapsackSolution* cm_grasp_construction(Evaluator<KnapsackSolution> *evl, double alpha, Budget *budget, Random *rng) {
+    Budget construction_budget(budget, GRASP_CONSTRUCTION_SECONDS);
+    return cm_knapsack_greedy_randomized((KnapsackEvaluator*) evl, alpha, &construction_budget, rng);
+}
+
+KnapsackSimulatedAnnealing mh_simulated_annealing(
+    KnapsackEvaluator *evl, KnapsackInversionMovementGenerator *mg, KnapsackSolution *s, Random *rng
+) {
+    return KnapsackSimulatedAnnealing(
+        evl, mg, s, SA_MAX,
+        SA_ALPHA, SA_BETA, SA_GAMMA, SA_T_MIN, rng
+    );
+}
+
+GraspWorker::GraspWorker(KnapsackEvaluator *evl, KnapsackInversionMovementGenerator *mg, uint64_t stream)
+    : rng(Random::DEFAULT_SEED, stream), rs(evl, mg, SELECTION_SAMPLES, &this->rng), hill_climbing(evl, &this->rs) {}
+
+KnapsackSolution* run_algorithm(const std::string &algorithm, KnapsackEvaluator *evl, Budget *budget, Random *rng, std::ostream *log) {
+    if (!is_algorithm(algorithm))
+        throw std::invalid_argument("Unknown algorithm '" + algorithm + "'");
+
+    KnapsackInversionMovementGenerator mg(evl, evl->n);
+    KnapsackRandomSelection rs(evl, &mg, SELECTION_SAMPLES, rng);
+
+    if (algorithm == "grasp") {
+        LSHillClimbing<KnapsackSolution> hill_climbing(evl, &rs);
+        MHGrasp<KnapsackSolution> grasp(evl, cm_grasp_construction, GRASP_ALPHA, &hill_climbing, GRASP_MAX, rng);
+        grasp.set_log(log);
+        return grasp.run(budget);
+    }
+
+    Budget construction_budget(budget);
+    KnapsackSolution *s = cm_knapsack_greedy_randomized(evl, (algorithm == "sa" || algorithm == "pt") ? SA_START_ALPHA : GRASP_ALPHA, &construction_budget, rng);
+    budget->improved(evl->get_evaluation(s));
+
+    KnapsackSolution *s1;
+    if (algorithm == "hc") {
+        LSHillClimbing<KnapsackSolution> hill_climbing(evl, &rs);
+        s1 = hill_climbing.run(s, budget);
+    } else if (algorithm == "rdm") {
+        RandomDescentMethod<KnapsackSolution> random_descent(evl, &rs, DESCENT_MAX);
+        s1 = random_descent.run(s, budget);
+    } else {
+        KnapsackSimulatedAnnealing simulated_annealing = mh_simulated_annealing(evl, &mg, s, rng);
+        simulated_annealing.set_log(log);
+        if (algorithm == "sa") {
+            s1 = simulated_annealing.run(budget);
+        } else {
+            KnapsackParallelTempering parallel_tempering(
+                evl, &mg, s,
+                KnapsackParallelTempering::geometric_ladder(
+                    1, simulated_annealing.initial_temperature(s), PT_REPLICAS
+                ),
+                PT_SWEEP, PT_MAX, nullptr, rng
+            );
+            parallel_tempering.set_log(log);
+            s1 = parallel_tempering.run(budget);
+        }
+    }
+
+    delete s;
+    return s1;
+}
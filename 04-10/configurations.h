@@ -0,0 +1,57 @@
+#ifndef CONFIGURATIONS_H
+#define CONFIGURATIONS_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include "knapsack.h"
+#include "neighborhood_exploration.h"
+#include "meta_heuristics.h"
+
+// Algorithm configurations run by main.cpp and the tools, so that all of them compare the same searches.
+
+#define GRASP_ALPHA 0.5
+#define GRASP_MAX 1000
+#define GRASP_CONSTRUCTION_SECONDS 5
+#define SELECTION_SAMPLES 10000  // movements sampled by each random selection step
+#define DESCENT_MAX 10  // failed steps before the random descent method stops
+#define SA_START_ALPHA 0.9
+#define SA_MAX 100000
+#define SA_ALPHA 0.95
+#define SA_BETA 1.05
+#define SA_GAMMA 0.9
+#define SA_T_MIN 0.00001
+#define PT_REPLICAS 8
+#define PT_SWEEP 10000
+#define PT_MAX 1000000
+
+// Searches over the concrete generator, so that its calls are inlined.
+typedef RHRandomSelection<KnapsackSolution, KnapsackInversionMovement, KnapsackInversionMovementGenerator> KnapsackRandomSelection;
+typedef MHSimulatedAnnealing<KnapsackSolution, KnapsackInversionMovement, KnapsackInversionMovementGenerator> KnapsackSimulatedAnnealing;
+typedef MHParallelTempering<KnapsackSolution, KnapsackInversionMovement, KnapsackInversionMovementGenerator> KnapsackParallelTempering;
+
+// Names accepted by run_algorithm: grasp, sa, pt, hc and rdm.
+extern const std::vector<std::string> ALGORITHMS;
+bool is_algorithm(const std::string &name);
+
+// GRASP construction: greedy randomized, with at most GRASP_CONSTRUCTION_SECONDS of the iteration budget.
+KnapsackSolution* cm_grasp_construction(Evaluator<KnapsackSolution> *evl, double alpha, Budget *budget, Random *rng);
+
+KnapsackSimulatedAnnealing mh_simulated_annealing(
+    KnapsackEvaluator *evl, KnapsackInversionMovementGenerator *mg, KnapsackSolution *s, Random *rng = nullptr
+);
+
+// Random stream and local search of one parallel GRASP worker. Workers write their generator
+// state on every sample, so each one is allocated on its own cache lines.
+struct alignas(64) GraspWorker {
+    Random rng;
+    KnapsackRandomSelection rs;
+    LSHillClimbing<KnapsackSolution> hill_climbing;
+    GraspWorker(KnapsackEvaluator *evl, KnapsackInversionMovementGenerator *mg, uint64_t stream);
+};
+
+// Runs one configuration on budget, with every random choice drawn from rng. The local searches
+// (sa, pt, hc, rdm) start from a greedy randomized solution, which is reported to the budget.
+KnapsackSolution* run_algorithm(const std::string &algorithm, KnapsackEvaluator *evl, Budget *budget, Random *rng, std::ostream *log);
+
+#endif // CONFIGURATIONS_H
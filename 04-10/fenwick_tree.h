@@ -0,0 +1,25 @@
+#ifndef FENWICK_TREE_H
+#define FENWICK_TREE_H
+
+#include <vector>
+#include <cstddef>
+
+// Binary indexed tree over a[0..n-1]: point updates and prefix sums in O(log n).
+template <class T>
+class FenwickTree {
+private:
+    std::vector<T> tree;  // 1-indexed, tree[k] holds the sum of a(k - lowbit(k), k]
+public:
+    FenwickTree();  // empty, without allocating, until build()
+    explicit FenwickTree(size_t n);
+    size_t size() const;
+    void build(const std::vector<T> &a);  // O(n) rebuild from scratch
+    void add(size_t i, T x);
+    T prefix(size_t i) const;  // a[0] + ... + a[i - 1]
+    T range(size_t i, size_t j) const;  // a[i] + ... + a[j]
+    size_t select(T k) const;  // smallest i with a[0] + ... + a[i] > k, for non-negative a; size() if none
+};
+
+#include "fenwick_tree.tpp"
+
+#endif // FENWICK_TREE_H
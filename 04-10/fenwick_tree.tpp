@@ -0,0 +1,57 @@
+#include "fenwick_tree.h"
+
+template <class T>
+FenwickTree<T>::FenwickTree() {}
+
+template <class T>
+FenwickTree<T>::FenwickTree(size_t n) : tree(n + 1, T()) {}
+
+template <class T>
+size_t FenwickTree<T>::size() const {
+    return this->tree.empty() ? 0 : this->tree.size() - 1;
+}
+
+template <class T>
+void FenwickTree<T>::build(const std::vector<T> &a) {
+    this->tree.assign(a.size() + 1, T());
+    for (size_t k = 1; k <= a.size(); k++) {
+        this->tree[k] += a[k - 1];
+        size_t parent = k + (k & (~k + 1));
+        if (parent <= a.size())
+            this->tree[parent] += this->tree[k];
+    }
+}
+
+template <class T>
+void FenwickTree<T>::add(size_t i, T x) {
+    for (size_t k = i + 1; k < this->tree.size(); k += k & (~k + 1))
+        this->tree[k] += x;
+}
+
+template <class T>
+T FenwickTree<T>::prefix(size_t i) const {
+    T r = T();
+    for (size_t k = i; k > 0; k -= k & (~k + 1))
+        r += this->tree[k];
+    return r;
+}
+
+template <class T>
+T FenwickTree<T>::range(size_t i, size_t j) const {
+    return this->prefix(j + 1) - this->prefix(i);
+}
+
+template <class T>
+size_t FenwickTree<T>::select(T k) const {
+    // descend from the largest power of two, skipping every block whose sum is still <= k
+    size_t n = this->size(), i = 0, step = 1;
+    while (step * 2 <= n) step *= 2;
+
+    for (; step > 0; step /= 2) {
+        if (i + step <= n && this->tree[i + step] <= k) {
+            i += step;
+            k -= this->tree[i];
+        }
+    }
+    return i;
+}
@@ -6,15 +6,19 @@ KnapsackSolution::KnapsackSolution(int n)
 {
     this->n = n;
     this->w = 0;
-    this->s = new bool[n];
-    for (int i = 0; i < n; i++)
-        this->s[i] = false;
+    this->words = (n + WORD_BITS - 1) / WORD_BITS;
+    this->s = new uint64_t[this->words]();
+    this->prefix_valid = false;
+}
+
+KnapsackSolution::~KnapsackSolution() {
+    delete[] this->s;
 }
 
 Solution* KnapsackSolution::clone() const {
+    Telemetry::count(TelemetryCounter::CLONES);
     KnapsackSolution *s = new KnapsackSolution(this->n);
-    for (int i = 0; i < this->n; i++)
-        s->s[i] = this->s[i];
+    std::memcpy(s->s, this->s, this->words * sizeof(uint64_t));
     s->w = this->w;
 
     if (this->is_evaluated())
@@ -23,439 +27,271 @@ Solution* KnapsackSolution::clone() const {
     return s;
 }
 
-size_t KnapsackSolution::size() const {
-    return this->n;
-}
+void KnapsackSolution::copy_from(const Solution *s) {
+    const KnapsackSolution *ks = (const KnapsackSolution*) s;
+    std::memcpy(this->s, ks->s, this->words * sizeof(uint64_t));
+    this->w = ks->w;
+    this->prefix_valid = false;
 
-bool KnapsackSolution::get(int i) const {
-    return this->s[i];
+    if (ks->is_evaluated())
+        this->set_evaluation(ks->get_last_evaluation());
+    else
+        this->clear_evaluation();
 }
 
-void KnapsackSolution::set(int i, bool x, KnapsackEvaluator *evl) {
-    if (this->s[i] == x) return;
-    this->flip(i, evl);
+size_t KnapsackSolution::size() const {
+    return this->n;
 }
 
-void KnapsackSolution::flip(int i, KnapsackEvaluator *evl) {
-    this->s[i] = !this->s[i];
-
-    if (evl == nullptr || !this->is_evaluated()) {
-        this->clear_evaluation();
-        return;
-    }
-
-    long long delta_v = evl->v[i], delta_w = evl->w[i];
-    if (!this->s[i]) {
-        delta_v *= -1;
-        delta_w *= -1;
-    }
-
-    this->w += delta_w;
-    long long new_v = this->get_last_evaluation() + delta_v;
-
-    this->set_evaluation(new_v);
+size_t KnapsackSolution::word_count() const {
+    return this->words;
 }
 
-KnapsackEvaluator::KnapsackEvaluator(int n, long long q, std::vector<int> v, std::vector<int> w) {
-    this->n = n;
-    this->q = q;
-    this->v = v;
-    this->w = w;
+uint64_t KnapsackSolution::word(size_t k) const {
+    return this->s[k];
 }
 
-long long KnapsackEvaluator::evaluate(const KnapsackSolution *s) const {
-    long long curr_weigh = 0;
-    long long curr_value = 0;
-    for (int i = 0; i < this->n; i++) {
-        if (s->get(i)) {
-            curr_value += this->v[i];
-            curr_weigh += this->w[i];
+void KnapsackSolution::build_prefix(const KnapsackEvaluator *evl) const {
+    std::vector<long long> a_v(this->n, 0), a_w(this->n, 0);
+    for (size_t k = 0; k < this->words; k++) {
+        for (uint64_t x = this->s[k]; x != 0; x &= x - 1) {
+            int i = k * WORD_BITS + __builtin_ctzll(x);
+            a_v[i] = evl->v[i];
+            a_w[i] = evl->w[i];
         }
     }
-    s->w = curr_weigh;
-    return curr_value;
-}
-
-long long KnapsackEvaluator::get_evaluation(const KnapsackSolution *s) const {
-    long long evaluation = Evaluator<KnapsackSolution>::get_evaluation(s);
-    
-    if (s->w > this->q) return KnapsackEvaluator::PUNISHMENT;
-    else return evaluation;
-}
-
-KnapsackMovement::KnapsackMovement(KnapsackEvaluator *evl) : evl(evl) {}
 
-KnapsackMovementGenerator::KnapsackMovementGenerator(KnapsackEvaluator *evl) {
-    this->evl = evl;
+    this->selected_v.build(a_v);
+    this->selected_w.build(a_w);
+    this->prefix_valid = true;
 }
 
-Knapsack2FlipBitMovement::Knapsack2FlipBitMovement(KnapsackEvaluator *evl, int i, int j)
-    : KnapsackMovement(evl)
-{
-    this->i = i;
-    this->j = j;
+KnapsackEvaluator::KnapsackEvaluator(const KnapsackInstance *instance) {
+    this->owned_instance = nullptr;
+    this->view(instance);
 }
 
-void Knapsack2FlipBitMovement::move(KnapsackSolution *s) {
-    if (this->i == this->j) {
-        s->flip(this->i, this->evl);
-    } else {
-        s->flip(this->i, this->evl);
-        s->flip(this->j, this->evl);
-    }
+KnapsackEvaluator::KnapsackEvaluator(int n, long long q, std::vector<int> v, std::vector<int> w) {
+    this->owned_instance = new KnapsackInstance(n, q, std::move(v), std::move(w));
+    this->view(this->owned_instance);
 }
 
-long long Knapsack2FlipBitMovement::delta(const KnapsackSolution *s) const {
-    long long a = this->evl->get_evaluation(s);
-    
-    long long delta_v = 0;
-    long long total_w = s->w;
-
-    delta_v += ((s->get(this->i)) ? -1 : 1) * this->evl->v[this->i] ;
-    total_w += ((s->get(this->i)) ? -1 : 1) * this->evl->w[this->i];
-    
-    if (this->i != this->j) {
-        delta_v += ((s->get(this->j)) ? -1 : 1) * this->evl->v[this->j];
-        total_w += ((s->get(this->j)) ? -1 : 1) * this->evl->w[this->j];
-    }
+void KnapsackEvaluator::view(const KnapsackInstance *instance) {
+    this->n = instance->n;
+    this->q = instance->q;
+    this->v = instance->v;
+    this->w = instance->w;
 
-    if (total_w > this->evl->q) {
-        return KnapsackEvaluator::PUNISHMENT;
+    this->prefix_v.assign(this->n + 1, 0);
+    this->prefix_w.assign(this->n + 1, 0);
+    for (int i = 0; i < this->n; i++) {
+        this->prefix_v[i + 1] = this->prefix_v[i] + this->v[i];
+        this->prefix_w[i + 1] = this->prefix_w[i] + this->w[i];
     }
-
-    return delta_v;
 }
 
-KnapsackIntervalFlipBitMovement::KnapsackIntervalFlipBitMovement(KnapsackEvaluator *evl, int i, int j)
-    : KnapsackMovement(evl)
-{
-    this->i = i;
-    this->j = j;
-}
-
-void KnapsackIntervalFlipBitMovement::move(KnapsackSolution *s) {
-    for (int k = this->i; k <= this->j; k++)
-        s->flip(k, this->evl);
+KnapsackEvaluator::~KnapsackEvaluator() {
+    delete this->owned_instance;
 }
 
-long long KnapsackIntervalFlipBitMovement::delta(const KnapsackSolution *s) const {
-    long long a = this->evl->get_evaluation(s);
-    
-    long long delta_v = 0;
-    long long total_w = s->w;
-
-    for (int k = this->i; k <= this->j; k++) {
-        delta_v += ((s->get(k)) ? -1 : 1) * this->evl->v[k];
-        total_w += ((s->get(k)) ? -1 : 1) * this->evl->w[k];
-    }
-
-    if (total_w > this->evl->q) {
-        return KnapsackEvaluator::PUNISHMENT;
+long long KnapsackEvaluator::evaluate(const KnapsackSolution *s) const {
+    Telemetry::count(TelemetryCounter::EVALUATIONS);
+    long long curr_weigh = 0;
+    long long curr_value = 0;
+    for (size_t k = 0; k < s->word_count(); k++) {
+        uint64_t x = s->word(k);
+        const int *v = this->v + k * KnapsackSolution::WORD_BITS;
+        const int *w = this->w + k * KnapsackSolution::WORD_BITS;
+
+        // visit only the set bits of the word, lowest first
+        while (x != 0) {
+            int b = __builtin_ctzll(x);
+            curr_value += v[b];
+            curr_weigh += w[b];
+            x &= x - 1;
+        }
     }
-
-    return delta_v;
+    s->w = curr_weigh;
+    return curr_value;
 }
 
-KnapsackInversionMovement::KnapsackInversionMovement(KnapsackEvaluator *evl, int i, int j)
-    : KnapsackMovement(evl)
-{
-    this->i = i;
-    this->j = j;
+const std::vector<int>& KnapsackEvaluator::ratio_order() const {
+    std::call_once(this->ratio_once, [this]() {
+        this->ratio_ordered.resize(this->n);
+        std::iota(this->ratio_ordered.begin(), this->ratio_ordered.end(), 0);
+        std::sort(this->ratio_ordered.begin(), this->ratio_ordered.end(), [this](const int x, const int y) {
+            long long qx = (long long) this->v[x] * this->w[y],
+                      qy = (long long) this->v[y] * this->w[x];
+            return (qx != qy) ? qx > qy : x < y;
+        });
+    });
+    return this->ratio_ordered;
 }
 
-void KnapsackInversionMovement::move(KnapsackSolution *s) {
-    for (int k = 0; k < (this->j - this->i + 1) / 2; k++) {
-        int a = this->i + k,
-            b = this->j - k;
-        s->flip(a, this->evl);
-        s->flip(b, this->evl);
-    }
+const std::vector<int>& KnapsackEvaluator::weight_order() const {
+    std::call_once(this->weight_once, [this]() {
+        this->weight_ordered.resize(this->n);
+        std::iota(this->weight_ordered.begin(), this->weight_ordered.end(), 0);
+        std::sort(this->weight_ordered.begin(), this->weight_ordered.end(), [this](const int x, const int y) {
+            return (this->w[x] != this->w[y]) ? this->w[x] < this->w[y] : x < y;
+        });
+    });
+    return this->weight_ordered;
 }
 
-long long KnapsackInversionMovement::delta(const KnapsackSolution *s) const {
-    long long a = this->evl->get_evaluation(s);
-    
-    long long delta_v = 0;
-    long long total_w = s->w;
-
-    for (int k = 0; k < (this->j - this->i + 1) / 2; k++) {
-        int a = this->i + k,
-            b = this->j - k;
-        delta_v += ((s->get(a)) ? -1 : 1) * this->evl->v[a];
-        delta_v += ((s->get(b)) ? -1 : 1) * this->evl->v[b];
-        total_w += ((s->get(a)) ? -1 : 1) * this->evl->w[a];
-        total_w += ((s->get(b)) ? -1 : 1) * this->evl->w[b];
-    }
-
-    if (total_w > this->evl->q) {
-        return KnapsackEvaluator::PUNISHMENT;
-    }
-
-    return delta_v;
+const std::vector<int>& KnapsackEvaluator::value_order() const {
+    std::call_once(this->value_once, [this]() {
+        this->value_ordered.resize(this->n);
+        std::iota(this->value_ordered.begin(), this->value_ordered.end(), 0);
+        std::sort(this->value_ordered.begin(), this->value_ordered.end(), [this](const int x, const int y) {
+            return (this->v[x] != this->v[y]) ? this->v[x] > this->v[y] : x < y;
+        });
+    });
+    return this->value_ordered;
 }
 
-Knapsack2FlipBitMovementGenerator::Knapsack2FlipBitMovementGenerator(KnapsackEvaluator *evl, int n)
-    : KnapsackMovementGenerator(evl)
-{
-    this->n = n;
-    this->curr_i = 0;
-    this->curr_j = 0;
+long long KnapsackEvaluator::get_evaluation(const KnapsackSolution *s) const {
+    long long evaluation = Evaluator<KnapsackSolution>::get_evaluation(s);
+    
+    if (s->w > this->q) return KnapsackEvaluator::PUNISHMENT;
+    else return evaluation;
 }
 
-std::vector<Movement<KnapsackSolution>*> Knapsack2FlipBitMovementGenerator::get_all(const KnapsackSolution *s) {
-    std::vector<Movement<KnapsackSolution>*> movements;
-    for (int i = 0; i < this->n; i++) {
-        for (int j = i; j < this->n; j++) {
-            movements.push_back(new Knapsack2FlipBitMovement(this->evl, i, j));
-        }
-    }
-    return movements;
-}
+KnapsackSolution* cm_knapsack_greedy(const KnapsackEvaluator *evl, Budget *budget) {
+    long long curr_Q = evl->q;
+    KnapsackSolution *s = new KnapsackSolution(evl->n);
 
-Movement<KnapsackSolution>* Knapsack2FlipBitMovementGenerator::get_random() {
-    int i = rand() % this->n;
-    int j = rand() % this->n;
-    return new Knapsack2FlipBitMovement(this->evl, i, j);
-}
+    for (int g : evl->ratio_order()) {
+        if (budget->expired())
+            break;
 
-bool Knapsack2FlipBitMovementGenerator::has_next() {
-    return this->curr_i < this->n;
-}
+        if (evl->w[g] > curr_Q)
+            continue;
 
-Movement<KnapsackSolution>* Knapsack2FlipBitMovementGenerator::next() {
-    if (this->curr_i == this->n) return nullptr;
-    Knapsack2FlipBitMovement *m = new Knapsack2FlipBitMovement(this->evl, this->curr_i, this->curr_j);
-    this->curr_j++;
-    if (this->curr_j == this->n) {
-        this->curr_i++;
-        this->curr_j = this->curr_i;
+        curr_Q -= evl->w[g];
+        s->set(g, true);
     }
-    return m;
-}
 
-void Knapsack2FlipBitMovementGenerator::reset() {
-    this->curr_i = 0;
-    this->curr_j = 0;
-}
-
-KnapsackIntervalFlipBitMovementGenerator::KnapsackIntervalFlipBitMovementGenerator(KnapsackEvaluator *evl, int n)
-    : KnapsackMovementGenerator(evl)
-{
-    this->n = n;
-    this->curr_i = 0;
-    this->curr_j = 0;
+    return s;
 }
 
-std::vector<Movement<KnapsackSolution>*> KnapsackIntervalFlipBitMovementGenerator::get_all(const KnapsackSolution *s) {
-    std::vector<Movement<KnapsackSolution>*> movements;
-    for (int i = 0; i < this->n; i++) {
-        for (int j = i; j < this->n; j++) {
-            movements.push_back(new KnapsackIntervalFlipBitMovement(this->evl, i, j));
-        }
+namespace {
+
+// Alive positions of an item order, counted by a Fenwick tree so that the r-th alive one is found in O(log n).
+class CandidateSet {
+private:
+    const KnapsackEvaluator *evl;
+    std::vector<int> rank;  // position of each item in the order
+    std::vector<bool> alive;
+    FenwickTree<int> alive_count;
+    int heavy;  // the weight order before it holds every item that may still fit
+public:
+    int size;
+    CandidateSet(const KnapsackEvaluator *evl, const std::vector<int> &order)
+        : evl(evl), rank(evl->n), alive(evl->n, true), heavy(evl->n - 1), size(evl->n)
+    {
+        for (int k = 0; k < evl->n; k++)
+            this->rank[order[k]] = k;
+        this->alive_count.build(std::vector<int>(evl->n, 1));
     }
-    return movements;
-}
 
-Movement<KnapsackSolution>* KnapsackIntervalFlipBitMovementGenerator::get_random() {
-    int i = rand() % this->n;
-    int j = rand() % this->n;
-    return new KnapsackIntervalFlipBitMovement(this->evl, i, j);
-}
-
-bool KnapsackIntervalFlipBitMovementGenerator::has_next() {
-    return this->curr_i < this->n;
-}
-
-Movement<KnapsackSolution>* KnapsackIntervalFlipBitMovementGenerator::next() {
-    if (this->curr_i == this->n) return nullptr;
-    KnapsackIntervalFlipBitMovement *m = new KnapsackIntervalFlipBitMovement(this->evl, this->curr_i, this->curr_j);
-    this->curr_j++;
-    if (this->curr_j == this->n) {
-        this->curr_i++;
-        this->curr_j = this->curr_i;
+    void remove(size_t k) {
+        this->alive[k] = false;
+        this->alive_count.add(k, -1);
+        this->size--;
     }
-    return m;
-}
 
-void KnapsackIntervalFlipBitMovementGenerator::reset() {
-    this->curr_i = 0;
-    this->curr_j = 0;
-}
-
-KnapsackInversionMovementGenerator::KnapsackInversionMovementGenerator(KnapsackEvaluator *evl, int n)
-    : KnapsackMovementGenerator(evl)
-{
-    this->n = n;
-    this->curr_i = 0;
-    this->curr_j = 0;
-}
-
-std::vector<Movement<KnapsackSolution>*> KnapsackInversionMovementGenerator::get_all(const KnapsackSolution *s) {
-    std::vector<Movement<KnapsackSolution>*> movements;
-    for (int i = 0; i < this->n; i++) {
-        for (int j = i; j < this->n; j++) {
-            movements.push_back(new KnapsackInversionMovement(evl, i, j));
+    // the items heavier than the capacity are a suffix of the weight order, which only grows as it shrinks
+    void remove_heavier_than(long long capacity) {
+        const std::vector<int> &c_weight_ordered = this->evl->weight_order();
+        for (; this->heavy >= 0 && this->evl->w[c_weight_ordered[this->heavy]] > capacity; this->heavy--) {
+            int k = this->rank[c_weight_ordered[this->heavy]];
+            if (this->alive[k]) this->remove(k);
         }
     }
-    return movements;
-}
 
-Movement<KnapsackSolution>* KnapsackInversionMovementGenerator::get_random() {
-    int i = rand() % this->n;
-    int j = rand() % this->n;
-    return new KnapsackInversionMovement(this->evl, i, j);
-}
-
-bool KnapsackInversionMovementGenerator::has_next() {
-    return this->curr_i < this->n;
-}
-
-Movement<KnapsackSolution>* KnapsackInversionMovementGenerator::next() {
-    if (this->curr_i == this->n) return nullptr;
-    KnapsackInversionMovement *m = new KnapsackInversionMovement(this->evl, this->curr_i, this->curr_j);
-    this->curr_j++;
-    if (this->curr_j == this->n) {
-        this->curr_i++;
-        this->curr_j = this->curr_i;
+    size_t select(int r) const {  // position of the r-th alive candidate, from 0
+        return this->alive_count.select(r);
     }
-    return m;
-}
-
-void KnapsackInversionMovementGenerator::reset() {
-    this->curr_i = 0;
-    this->curr_j = 0;
-}
-
-KnapsackSolution* cm_knapsack_greedy(const KnapsackEvaluator *evl, double t) {
-    auto start = std::chrono::high_resolution_clock::now();
-
-    long long curr_Q = evl->q;
-    KnapsackSolution *s = new KnapsackSolution(evl->n);
-
-    std::vector<int> c(evl->n);
-    std::iota(c.begin(), c.end(), 0);
-    std::sort(c.begin(), c.end(), [&](const int x, const int y) {
-        float qx = evl->v[x] / (float) evl->w[x],
-              qy = evl->v[y] / (float) evl->w[y];
-        return qx > qy;
-    });
-
-    for (int g : c) {
-        auto current = std::chrono::high_resolution_clock::now();
-        if (std::chrono::duration<double>(current - start).count() > t)
-            break;
 
-        if (evl->w[g] > curr_Q)
-            continue;
-
-        curr_Q -= evl->w[g];
-        s->set(g, true);
+    int count_before(size_t k) const {  // alive candidates at positions below k
+        return this->alive_count.prefix(k);
     }
+};
 
-    return s;
 }
 
-KnapsackSolution* cm_knapsack_random(const KnapsackEvaluator *evl, double t) {
-    auto start = std::chrono::high_resolution_clock::now();
+KnapsackSolution* cm_knapsack_random(const KnapsackEvaluator *evl, Budget *budget, Random *rng) {
+    rng = Random::or_default(rng);
 
     long long curr_Q = evl->q;
     KnapsackSolution *s = new KnapsackSolution(evl->n);
 
-    std::vector<int> c_weight_ordered(evl->n);
-    iota(c_weight_ordered.begin(), c_weight_ordered.end(), 0);
-    sort(c_weight_ordered.begin(), c_weight_ordered.end(), [&](const int x, const int y) {
-        return evl->w[x] < evl->w[y];
-    });
-
-    while (c_weight_ordered.size() > 0 && curr_Q < evl->w[(*c_weight_ordered.rbegin())]) {
-        c_weight_ordered.pop_back();
-    }
+    const std::vector<int> &c_weight_ordered = evl->weight_order();
+    CandidateSet candidates(evl, c_weight_ordered);
 
-    while (c_weight_ordered.size() > 0 && curr_Q >= evl->w[c_weight_ordered[0]]) {
-        auto current = std::chrono::high_resolution_clock::now();
-        if (std::chrono::duration<double>(current - start).count() > t)
+    candidates.remove_heavier_than(curr_Q);
+    while (candidates.size > 0) {
+        if (budget->expired())
             break;
 
-        auto g = c_weight_ordered.begin() + (rand() % c_weight_ordered.size());
-        s->set(*g, true);
-        curr_Q -= evl->w[*g];
-        c_weight_ordered.erase(g);
+        size_t k = candidates.select(rng->uniform_int(candidates.size));
+        int g = c_weight_ordered[k];
+        s->set(g, true);
+        curr_Q -= evl->w[g];
 
-        while (c_weight_ordered.size() > 0 && curr_Q < evl->w[(*c_weight_ordered.rbegin())]) {
-           c_weight_ordered.pop_back();
-        }
+        candidates.remove(k);
+        candidates.remove_heavier_than(curr_Q);
     }
 
     return s;
 }
 
-KnapsackSolution* cm_knapsack_greedy_randomized(const KnapsackEvaluator *evl, float a, double t) {
-    auto start = std::chrono::high_resolution_clock::now();
+KnapsackSolution* cm_knapsack_greedy_randomized(const KnapsackEvaluator *evl, float a, Budget *budget, Random *rng) {
+    rng = Random::or_default(rng);
 
     KnapsackSolution *s = new KnapsackSolution(evl->n);
     long long curr_Q = evl->q;
 
-    std::vector<float> values;
-    for (int i = 0; i < evl->n; i++) {
-        float value = evl->v[i] / (float) evl->w[i];
-        values.push_back(value);
-    }
+    const std::vector<int> &c_value_ordered = evl->ratio_order();
+    CandidateSet candidates(evl, c_value_ordered);
 
-    std::vector<int> c_weight_ordered(evl->n), c_value_ordered(evl->n);
-    std::iota(c_weight_ordered.begin(), c_weight_ordered.end(), 0);
-    std::iota(c_value_ordered.begin(), c_value_ordered.end(), 0);
-
-    std::sort(c_weight_ordered.rbegin(), c_weight_ordered.rend(), [&](const int x, const int y) {
-        return evl->w[x] > evl->w[y];
-    });
-
-    std::sort(c_value_ordered.rbegin(), c_value_ordered.rend(), [&](const int x, const int y) {
-        return values[x] < values[y];
-    });
-
-    while (c_weight_ordered.size() > 0 && evl->w[*c_weight_ordered.rbegin()] > curr_Q) {
-        c_weight_ordered.pop_back();
-        c_value_ordered.erase(
-            std::remove(c_value_ordered.begin(), c_value_ordered.end(), *c_weight_ordered.begin()),
-            c_value_ordered.end()
-        );
+    std::vector<double> values(evl->n);  // values[k]: ratio of the k-th item of the ratio order, non-increasing
+    for (int k = 0; k < evl->n; k++) {
+        int i = c_value_ordered[k];
+        values[k] = evl->v[i] / (double) evl->w[i];
     }
 
-    while (c_weight_ordered.size() > 0) {
-        auto current = std::chrono::high_resolution_clock::now();
-        if (std::chrono::duration<double>(current - start).count() > t)
+    candidates.remove_heavier_than(curr_Q);
+    while (candidates.size > 0) {
+        if (budget->expired())
             break;
 
-        float min_value = values[c_value_ordered.back()],
-              max_value = values[c_value_ordered.front()];
+        double max_value = values[candidates.select(0)],
+               min_value = values[candidates.select(candidates.size - 1)];
 
-        float threshold = max_value - a * (max_value - min_value);
+        double threshold = max_value - a * (max_value - min_value);
 
+        // the restricted candidate list is every alive item of ratio at least threshold,
+        // i.e. the alive positions before the first one of the ratio order below it
         auto rc_end = std::lower_bound(
-            c_value_ordered.begin(),
-            c_value_ordered.end(),
+            values.begin(),
+            values.end(),
             threshold,
-            [&](const int x, const float threshold) {
-                return values[x] >= threshold;
+            [](const double value, const double threshold) {
+                return value >= threshold;
             }
         );
+        int rc_size = std::max(candidates.count_before(rc_end - values.begin()), 1);
 
-        size_t rc_size = std::distance(rc_end, c_value_ordered.end());
-        int g = (rc_size == 0) ? c_value_ordered[0] : c_value_ordered[std::rand() % rc_size];
+        size_t k = candidates.select(rng->uniform_int(rc_size));
+        int g = c_value_ordered[k];
 
         curr_Q -= evl->w[g];
         s->set(g, true);
 
-        c_weight_ordered.erase(std::remove(c_weight_ordered.begin(), c_weight_ordered.end(), g), c_weight_ordered.end());
-        c_value_ordered.erase(std::remove(c_value_ordered.begin(), c_value_ordered.end(), g), c_value_ordered.end());
-
-        while (c_weight_ordered.size() > 0 && evl->w[*c_weight_ordered.rbegin()] > curr_Q) {
-            c_weight_ordered.pop_back();
-            c_value_ordered.erase(
-                remove(c_value_ordered.begin(), c_value_ordered.end(), *c_weight_ordered.begin()),
-                c_value_ordered.end()
-            );
-        }
+        candidates.remove(k);
+        candidates.remove_heavier_than(curr_Q);
     }
 
     return s;
@@ -2,123 +2,133 @@
 #define KNAPSACK_H
 
 #include "optimization.hpp"
+#include "fenwick_tree.h"
+#include "budget.h"
+#include "knapsack_instance.h"
+#include "telemetry.h"
 #include <vector>
 #include <chrono>
 #include <algorithm>
 #include <cstdlib>
 #include <numeric>
 #include <climits>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <mutex>
 
 class KnapsackEvaluator;
 
 class KnapsackSolution : public Solution {
 private:
     size_t n;
-    bool *s;
+    size_t words;  // 64 items per word, unused high bits of the last word stay 0
+    uint64_t *s;
+    mutable FenwickTree<long long> selected_v, selected_w;  // selected item values and weights, built on demand
+    mutable bool prefix_valid;
+    void build_prefix(const KnapsackEvaluator *evl) const;
 public:
+    static const int WORD_BITS = 64;
     mutable long long w;
     KnapsackSolution(int n);
+    KnapsackSolution(const KnapsackSolution&) = delete;
+    KnapsackSolution& operator=(const KnapsackSolution&) = delete;
+    ~KnapsackSolution();
     Solution* clone() const override;
+    void copy_from(const Solution *s) override;
     size_t size() const;
-    bool get(int i) const;
-    void set(int i, bool x, KnapsackEvaluator *evl = nullptr);
-    void flip(int i, KnapsackEvaluator *evl = nullptr);
+    size_t word_count() const;
+    uint64_t word(size_t k) const;
+    inline bool get(int i) const;
+    inline void set(int i, bool x, KnapsackEvaluator *evl = nullptr);
+    inline void flip(int i, KnapsackEvaluator *evl = nullptr);
+    inline void selected_sums(int i, int j, const KnapsackEvaluator *evl, long long *v, long long *w) const;
 };
 
 class KnapsackEvaluator : public Evaluator<KnapsackSolution> {
+private:
+    KnapsackInstance *owned_instance;  // set when the evaluator was built from vectors
+    void view(const KnapsackInstance *instance);
+    // item orderings, each built on first use and shared by every caller afterwards
+    mutable std::once_flag ratio_once, weight_once, value_once;
+    mutable std::vector<int> ratio_ordered, weight_ordered, value_ordered;
 public:
     static const long long PUNISHMENT = LLONG_MIN;
     int n;  // item quantity
     long long q;  // capacity
-    std::vector<int> v;  // item values
-    std::vector<int> w;  // item weights
-    KnapsackEvaluator(int n, long long q, std::vector<int> v, std::vector<int> w);
+    const int *v;  // item values
+    const int *w;  // item weights
+    std::vector<long long> prefix_v, prefix_w;  // prefix_v[i] = v[0] + ... + v[i - 1]
+    KnapsackEvaluator(const KnapsackInstance *instance);  // views the instance arrays, which must outlive the evaluator
+    KnapsackEvaluator(int n, long long q, std::vector<int> v, std::vector<int> w);  // takes the vectors over
+    KnapsackEvaluator(const KnapsackEvaluator&) = delete;
+    KnapsackEvaluator& operator=(const KnapsackEvaluator&) = delete;
+    ~KnapsackEvaluator();
     long long evaluate(const KnapsackSolution *s) const override;
     long long get_evaluation(const KnapsackSolution *s) const override;
+    // Ties are broken by item index, so the orders are deterministic.
+    const std::vector<int>& ratio_order() const;  // decreasing v / w, compared exactly as v[x] * w[y] > v[y] * w[x]
+    const std::vector<int>& weight_order() const;  // increasing w
+    const std::vector<int>& value_order() const;  // decreasing v
 };
 
-class KnapsackMovement : public Movement<KnapsackSolution> {
+class KnapsackMovement {
 public:
     KnapsackEvaluator *evl;
-    KnapsackMovement(KnapsackEvaluator *evl);
+    int i, j;
+    KnapsackMovement() = default;
+    KnapsackMovement(KnapsackEvaluator *evl, int i, int j);
 };
 
 class Knapsack2FlipBitMovement : public KnapsackMovement {
-private:
-    int i, j;
 public:
-    Knapsack2FlipBitMovement(KnapsackEvaluator *evl, int i, int j);
-    void move(KnapsackSolution *s) override;
-    long long delta(const KnapsackSolution *s) const override;
+    using KnapsackMovement::KnapsackMovement;
+    void move(KnapsackSolution *s) const;
+    void undo(KnapsackSolution *s) const;
+    long long delta(const KnapsackSolution *s) const;
 };
 
 class KnapsackIntervalFlipBitMovement : public KnapsackMovement {
-private:
-    int i, j;
 public:
-    KnapsackIntervalFlipBitMovement(KnapsackEvaluator *evl, int i, int j);
-    void move(KnapsackSolution *s) override;
-    long long delta(const KnapsackSolution *s) const override;
+    using KnapsackMovement::KnapsackMovement;
+    void move(KnapsackSolution *s) const;
+    void undo(KnapsackSolution *s) const;
+    long long delta(const KnapsackSolution *s) const;
 };
 
 class KnapsackInversionMovement : public KnapsackMovement {
-private:
-    int i, j;
 public:
-    KnapsackInversionMovement(KnapsackEvaluator *evl, int i, int j);
-    void move(KnapsackSolution *s) override;
-    long long delta(const KnapsackSolution *s) const override;
+    using KnapsackMovement::KnapsackMovement;
+    void move(KnapsackSolution *s) const;
+    void undo(KnapsackSolution *s) const;
+    long long delta(const KnapsackSolution *s) const;
 };
 
-class KnapsackMovementGenerator : public MovementGenerator<KnapsackSolution> {
-public:
-    KnapsackEvaluator *evl;
-    KnapsackMovementGenerator(KnapsackEvaluator *evl);
-};
-
-class Knapsack2FlipBitMovementGenerator : public KnapsackMovementGenerator {
+// Enumerates the (i, j) pairs with 0 <= i <= j < n, building MovementClass values for them.
+// Final, so searches templated on it call its methods directly.
+template <class MovementClass>
+class KnapsackMovementGenerator final : public MovementGenerator<KnapsackSolution, MovementClass> {
 private:
     int n;
-    int curr_i, curr_j;
 public:
-    Knapsack2FlipBitMovementGenerator(KnapsackEvaluator *evl, int n);
-    std::vector<Movement<KnapsackSolution>*> get_all(const KnapsackSolution *s) override;
-    Movement<KnapsackSolution>* get_random() override;
-    bool has_next() override;
-    Movement<KnapsackSolution>* next() override;
-    void reset() override;
+    KnapsackEvaluator *evl;
+    KnapsackMovementGenerator(KnapsackEvaluator *evl, int n);
+    size_t size() const override;
+    MovementClass at(size_t k) const override;
+    void advance(MovementClass *m) const override;
+    MovementClass get_random(Random *rng) const override;
 };
 
-class KnapsackIntervalFlipBitMovementGenerator : public KnapsackMovementGenerator {
-private:
-    int n;
-    int curr_i, curr_j;
-public:
-    KnapsackIntervalFlipBitMovementGenerator(KnapsackEvaluator *evl, int n);
-    std::vector<Movement<KnapsackSolution>*> get_all(const KnapsackSolution *s) override;
-    Movement<KnapsackSolution>* get_random() override;
-    bool has_next() override;
-    Movement<KnapsackSolution>* next() override;
-    void reset() override;
-};
+typedef KnapsackMovementGenerator<Knapsack2FlipBitMovement> Knapsack2FlipBitMovementGenerator;
+typedef KnapsackMovementGenerator<KnapsackIntervalFlipBitMovement> KnapsackIntervalFlipBitMovementGenerator;
+typedef KnapsackMovementGenerator<KnapsackInversionMovement> KnapsackInversionMovementGenerator;
 
-class KnapsackInversionMovementGenerator : public KnapsackMovementGenerator {
-private:
-    int n;
-    int curr_i, curr_j;
-public:
-    KnapsackInversionMovementGenerator(KnapsackEvaluator *evl, int n);
-    std::vector<Movement<KnapsackSolution>*> get_all(const KnapsackSolution *s) override;
-    Movement<KnapsackSolution>* get_random() override;
-    bool has_next() override;
-    Movement<KnapsackSolution>* next() override;
-    void reset() override;
-};
+KnapsackSolution* cm_knapsack_greedy(const KnapsackEvaluator *evl, Budget *budget);
 
-KnapsackSolution* cm_knapsack_greedy(const KnapsackEvaluator *evl, double t);
+KnapsackSolution* cm_knapsack_random(const KnapsackEvaluator *evl, Budget *budget, Random *rng = nullptr);
 
-KnapsackSolution* cm_knapsack_random(const KnapsackEvaluator *evl, double t);
+KnapsackSolution* cm_knapsack_greedy_randomized(const KnapsackEvaluator *evl, float a, Budget *budget, Random *rng = nullptr);
 
-KnapsackSolution* cm_knapsack_greedy_randomized(const KnapsackEvaluator *evl, float a, double t);
+#include "knapsack.tpp"
 
 #endif // KNAPSACK_H
@@ -0,0 +1,201 @@
+#include "knapsack.h"
+
+inline bool KnapsackSolution::get(int i) const {
+    return (this->s[i / WORD_BITS] >> (i % WORD_BITS)) & 1;
+}
+
+inline void KnapsackSolution::set(int i, bool x, KnapsackEvaluator *evl) {
+    if (this->get(i) == x) return;
+    this->flip(i, evl);
+}
+
+inline void KnapsackSolution::flip(int i, KnapsackEvaluator *evl) {
+    this->s[i / WORD_BITS] ^= (uint64_t) 1 << (i % WORD_BITS);
+
+    if (evl == nullptr) {
+        this->clear_evaluation();
+        this->prefix_valid = false;
+        return;
+    }
+
+    long long delta_v = evl->v[i], delta_w = evl->w[i];
+    if (!this->get(i)) {
+        delta_v *= -1;
+        delta_w *= -1;
+    }
+
+    if (this->prefix_valid) {
+        this->selected_v.add(i, delta_v);
+        this->selected_w.add(i, delta_w);
+    }
+
+    if (!this->is_evaluated()) return;
+
+    this->w += delta_w;
+    long long new_v = this->get_last_evaluation() + delta_v;
+
+    this->set_evaluation(new_v);
+}
+
+inline void KnapsackSolution::selected_sums(int i, int j, const KnapsackEvaluator *evl, long long *v, long long *w) const {
+    if (!this->prefix_valid)
+        this->build_prefix(evl);
+
+    *v = this->selected_v.range(i, j);
+    *w = this->selected_w.range(i, j);
+}
+
+inline KnapsackMovement::KnapsackMovement(KnapsackEvaluator *evl, int i, int j)
+    : evl(evl), i(i), j(j) {}
+
+inline void Knapsack2FlipBitMovement::move(KnapsackSolution *s) const {
+    if (this->i == this->j) {
+        s->flip(this->i, this->evl);
+    } else {
+        s->flip(this->i, this->evl);
+        s->flip(this->j, this->evl);
+    }
+}
+
+inline void Knapsack2FlipBitMovement::undo(KnapsackSolution *s) const {
+    // flipping the same bits again restores the solution
+    this->move(s);
+}
+
+inline long long Knapsack2FlipBitMovement::delta(const KnapsackSolution *s) const {
+    Telemetry::count(TelemetryCounter::DELTAS);
+    this->evl->get_evaluation(s);
+
+    long long delta_v = 0;
+    long long total_w = s->w;
+
+    delta_v += ((s->get(this->i)) ? -1 : 1) * this->evl->v[this->i] ;
+    total_w += ((s->get(this->i)) ? -1 : 1) * this->evl->w[this->i];
+
+    if (this->i != this->j) {
+        delta_v += ((s->get(this->j)) ? -1 : 1) * this->evl->v[this->j];
+        total_w += ((s->get(this->j)) ? -1 : 1) * this->evl->w[this->j];
+    }
+
+    if (total_w > this->evl->q) {
+        Telemetry::count(TelemetryCounter::INFEASIBLE_DELTAS);
+        return KnapsackEvaluator::PUNISHMENT;
+    }
+
+    return delta_v;
+}
+
+inline void KnapsackIntervalFlipBitMovement::move(KnapsackSolution *s) const {
+    for (int k = this->i; k <= this->j; k++)
+        s->flip(k, this->evl);
+}
+
+inline void KnapsackIntervalFlipBitMovement::undo(KnapsackSolution *s) const {
+    this->move(s);
+}
+
+inline long long KnapsackIntervalFlipBitMovement::delta(const KnapsackSolution *s) const {
+    Telemetry::count(TelemetryCounter::DELTAS);
+    this->evl->get_evaluation(s);
+
+    long long delta_v = 0;
+    long long total_w = s->w;
+
+    if (this->i <= this->j) {
+        // flipping [i, j] adds every item of the interval and removes twice the ones already selected
+        long long selected_v, selected_w;
+        s->selected_sums(this->i, this->j, this->evl, &selected_v, &selected_w);
+        delta_v = this->evl->prefix_v[this->j + 1] - this->evl->prefix_v[this->i] - 2 * selected_v;
+        total_w += this->evl->prefix_w[this->j + 1] - this->evl->prefix_w[this->i] - 2 * selected_w;
+    }
+
+    if (total_w > this->evl->q) {
+        Telemetry::count(TelemetryCounter::INFEASIBLE_DELTAS);
+        return KnapsackEvaluator::PUNISHMENT;
+    }
+
+    return delta_v;
+}
+
+inline void KnapsackInversionMovement::move(KnapsackSolution *s) const {
+    for (int k = 0; k < (this->j - this->i + 1) / 2; k++) {
+        int a = this->i + k,
+            b = this->j - k;
+        s->flip(a, this->evl);
+        s->flip(b, this->evl);
+    }
+}
+
+inline void KnapsackInversionMovement::undo(KnapsackSolution *s) const {
+    this->move(s);
+}
+
+inline long long KnapsackInversionMovement::delta(const KnapsackSolution *s) const {
+    Telemetry::count(TelemetryCounter::DELTAS);
+    this->evl->get_evaluation(s);
+
+    long long delta_v = 0;
+    long long total_w = s->w;
+
+    if (this->i <= this->j) {
+        long long selected_v, selected_w;
+        s->selected_sums(this->i, this->j, this->evl, &selected_v, &selected_w);
+        delta_v = this->evl->prefix_v[this->j + 1] - this->evl->prefix_v[this->i] - 2 * selected_v;
+        total_w += this->evl->prefix_w[this->j + 1] - this->evl->prefix_w[this->i] - 2 * selected_w;
+
+        // the pairs (i + k, j - k) cover the whole interval except its middle item when the length is odd
+        if ((this->j - this->i) % 2 == 0) {
+            int c = (this->i + this->j) / 2;
+            delta_v -= ((s->get(c)) ? -1 : 1) * this->evl->v[c];
+            total_w -= ((s->get(c)) ? -1 : 1) * this->evl->w[c];
+        }
+    }
+
+    if (total_w > this->evl->q) {
+        Telemetry::count(TelemetryCounter::INFEASIBLE_DELTAS);
+        return KnapsackEvaluator::PUNISHMENT;
+    }
+
+    return delta_v;
+}
+
+template <class MovementClass>
+KnapsackMovementGenerator<MovementClass>::KnapsackMovementGenerator(KnapsackEvaluator *evl, int n) {
+    this->evl = evl;
+    this->n = n;
+}
+
+template <class MovementClass>
+size_t KnapsackMovementGenerator<MovementClass>::size() const {
+    return (size_t) this->n * (this->n + 1) / 2;
+}
+
+template <class MovementClass>
+MovementClass KnapsackMovementGenerator<MovementClass>::at(size_t k) const {
+    // row i holds the n - i pairs (i, i..n-1) and starts at offset i * n - i * (i - 1) / 2
+    auto row_start = [&](long long i) { return i * this->n - i * (i - 1) / 2; };
+
+    double b = 2.0 * this->n + 1;
+    long long i = (long long) ((b - std::sqrt(b * b - 8.0 * k)) / 2);
+    i = std::max(0LL, std::min(i, (long long) this->n - 1));
+    while (i > 0 && row_start(i) > (long long) k) i--;
+    while (i + 1 < this->n && row_start(i + 1) <= (long long) k) i++;
+
+    return MovementClass(this->evl, i, i + (k - row_start(i)));
+}
+
+template <class MovementClass>
+void KnapsackMovementGenerator<MovementClass>::advance(MovementClass *m) const {
+    m->j++;
+    if (m->j == this->n) {
+        m->i++;
+        m->j = m->i;
+    }
+}
+
+template <class MovementClass>
+MovementClass KnapsackMovementGenerator<MovementClass>::get_random(Random *rng) const {
+    int i = rng->uniform_int(this->n);
+    int j = rng->uniform_int(this->n);
+    return MovementClass(this->evl, i, j);
+}
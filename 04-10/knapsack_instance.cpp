@@ -0,0 +1,187 @@
+#include "knapsack_instance.h"
+#include "mapped_file.h"
+#include <charconv>
+#include <stdexcept>
+#include <fstream>
+#include <cstring>
+#include <memory>
+
+KnapsackInstance::KnapsackInstance(int n, long long q, std::vector<int> v, std::vector<int> w)
+    : v_storage(std::move(v)), w_storage(std::move(w))
+{
+    if (this->v_storage.size() != (size_t) n || this->w_storage.size() != (size_t) n)
+        throw std::invalid_argument("Parameters 'v' and 'w' must hold n items.");
+
+    this->mapping = nullptr;
+    this->n = n;
+    this->q = q;
+    this->v = this->v_storage.data();
+    this->w = this->w_storage.data();
+}
+
+KnapsackInstance::KnapsackInstance(MappedFile *mapping, const std::string &path, bool verify_checksum) {
+    this->mapping = mapping;
+
+    auto fail = [&](const std::string &reason) {
+        delete this->mapping;
+        throw std::runtime_error("Malformed binary instance '" + path + "': " + reason);
+    };
+
+    KnapsackBinaryHeader header;
+    if (mapping->size() < sizeof(header)) fail("truncated header");
+    std::memcpy(&header, mapping->begin(), sizeof(header));
+
+    if (header.version != KnapsackBinaryHeader::VERSION)
+        fail("unsupported version " + std::to_string(header.version));
+    if (header.header_size != sizeof(header)) fail("unexpected header size");
+    if (header.n < 0 || header.n > INT32_MAX) fail("invalid item quantity");
+
+    uint64_t bytes = header.n * sizeof(int32_t);
+    for (uint64_t offset : { header.v_offset, header.w_offset }) {
+        if (offset % KnapsackBinaryHeader::ALIGNMENT != 0) fail("misaligned array");
+        if (offset < sizeof(header) || offset > mapping->size() || mapping->size() - offset < bytes) fail("truncated array");
+    }
+
+    this->n = header.n;
+    this->q = header.q;
+    this->v = (const int*) (mapping->begin() + header.v_offset);
+    this->w = (const int*) (mapping->begin() + header.w_offset);
+
+    if (verify_checksum && this->checksum() != header.checksum) fail("checksum mismatch");
+}
+
+KnapsackInstance::~KnapsackInstance() {
+    delete this->mapping;
+}
+
+uint64_t KnapsackInstance::checksum() const {
+    uint64_t h = KnapsackBinaryHeader::CHECKSUM_BASIS;
+    for (const int *a : { this->v, this->w }) {
+        for (int i = 0; i < this->n; i++)
+            h = KnapsackBinaryHeader::checksum_step(h, a[i]);
+    }
+    return h;
+}
+
+KnapsackBinaryHeader KnapsackBinaryHeader::layout(int64_t n, int64_t q, uint64_t checksum) {
+    KnapsackBinaryHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, MAGIC, sizeof(header.magic));
+    header.version = VERSION;
+    header.header_size = sizeof(header);
+    header.n = n;
+    header.q = q;
+    header.checksum = checksum;
+    header.v_offset = sizeof(header);
+    header.w_offset = (header.v_offset + n * sizeof(int32_t) + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    return header;
+}
+
+uint64_t KnapsackBinaryHeader::padding() const {
+    return this->w_offset - (this->v_offset + this->n * sizeof(int32_t));
+}
+
+void KnapsackInstance::save(const std::string &path) const {
+    KnapsackBinaryHeader header = KnapsackBinaryHeader::layout(this->n, this->q, this->checksum());
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+        throw std::runtime_error("Cannot create '" + path + "'");
+
+    const char zeros[KnapsackBinaryHeader::ALIGNMENT] = {};
+    file.write((const char*) &header, sizeof(header));
+    file.write((const char*) this->v, this->n * sizeof(int32_t));
+    file.write(zeros, header.padding());
+    file.write((const char*) this->w, this->n * sizeof(int32_t));
+
+    if (!file.good())
+        throw std::runtime_error("Cannot write '" + path + "'");
+}
+
+namespace {
+
+// Reads whitespace separated integers from [begin, end) with std::from_chars.
+class NumberReader {
+private:
+    const char *begin, *p, *end;
+    const std::string &path;
+public:
+    NumberReader(const char *begin, const char *end, const std::string &path)
+        : begin(begin), p(begin), end(end), path(path) {}
+
+    template <class T>
+    T next() {
+        while (this->p < this->end && (*this->p == ' ' || *this->p == '\t' || *this->p == '\n' || *this->p == '\r'))
+            this->p++;
+
+        T x;
+        auto [q, error] = std::from_chars(this->p, this->end, x);
+        if (error != std::errc())
+            throw std::runtime_error("Malformed instance '" + this->path + "' at byte " + std::to_string(this->p - this->begin));
+        this->p = q;
+        return x;
+    }
+
+    // numbers left on the current line
+    int count_on_line() const {
+        int count = 0;
+        bool in_number = false;
+        for (const char *c = this->p; c < this->end && *c != '\n'; c++) {
+            bool digit = (*c >= '0' && *c <= '9') || *c == '-';
+            if (digit && !in_number) count++;
+            in_number = digit;
+        }
+        return count;
+    }
+
+    void skip_line() {
+        while (this->p < this->end && *this->p != '\n') this->p++;
+        if (this->p < this->end) this->p++;
+    }
+};
+
+}
+
+KnapsackInstance* KnapsackInstance::load(const std::string &path, InstanceFormat format, bool verify_checksum) {
+    MappedFile *mapping = new MappedFile(path);
+    bool binary = mapping->size() >= sizeof(KnapsackBinaryHeader::MAGIC)
+        && std::memcmp(mapping->begin(), KnapsackBinaryHeader::MAGIC, sizeof(KnapsackBinaryHeader::MAGIC)) == 0;
+
+    if (format == InstanceFormat::BINARY || (format == InstanceFormat::AUTO && binary)) {
+        if (!binary) {
+            delete mapping;
+            throw std::runtime_error("Malformed binary instance '" + path + "': bad magic");
+        }
+        return new KnapsackInstance(mapping, path, verify_checksum);
+    }
+
+    // text is parsed into vectors, so the mapping is only needed until the end of this call
+    std::unique_ptr<MappedFile> file(mapping);
+    file->advise_sequential();
+    NumberReader reader(file->begin(), file->end(), path);
+
+    int n = reader.next<int>();
+    long long q = reader.next<long long>();
+    if (n < 0)
+        throw std::runtime_error("Malformed instance '" + path + "': negative item quantity");
+
+    if (format == InstanceFormat::AUTO) {
+        reader.skip_line();
+        format = (n != 2 && reader.count_on_line() == 2) ? InstanceFormat::INTERLEAVED : InstanceFormat::SEPARATED;
+    }
+
+    std::vector<int> v(n), w(n);
+    if (format == InstanceFormat::INTERLEAVED) {
+        for (int i = 0; i < n; i++) {
+            v[i] = reader.next<int>();
+            w[i] = reader.next<int>();
+        }
+    } else {
+        for (int i = 0; i < n; i++)
+            v[i] = reader.next<int>();
+        for (int i = 0; i < n; i++)
+            w[i] = reader.next<int>();
+    }
+
+    return new KnapsackInstance(n, q, std::move(v), std::move(w));
+}
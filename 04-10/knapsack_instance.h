@@ -0,0 +1,64 @@
+#ifndef KNAPSACK_INSTANCE_H
+#define KNAPSACK_INSTANCE_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+class MappedFile;
+
+enum class InstanceFormat {
+    AUTO,         // INTERLEAVED if the line after the header holds exactly two numbers, SEPARATED otherwise
+    SEPARATED,    // "n q", the n values, then the n weights (tests/instances-*)
+    INTERLEAVED,  // "n q", then one "value weight" line per item (original knapPI files)
+    BINARY        // KnapsackBinaryHeader followed by the value and weight arrays; AUTO detects it by its magic
+};
+
+// Header of the binary format, in native byte order. Both arrays hold n int32 and start
+// at offsets that are multiples of ALIGNMENT, so a mapped file can be used in place.
+struct KnapsackBinaryHeader {
+    static constexpr char MAGIC[8] = { 'K', 'N', 'A', 'P', 'B', 'I', 'N', '\0' };
+    static const uint32_t VERSION = 1;
+    static const uint64_t ALIGNMENT = 64;
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    int64_t n;
+    int64_t q;
+    uint64_t checksum;  // FNV-1a over the values then the weights, one int32 at a time
+    uint64_t v_offset;
+    uint64_t w_offset;
+    uint64_t reserved;
+    static const uint64_t CHECKSUM_BASIS = 0xcbf29ce484222325ULL;
+    static inline uint64_t checksum_step(uint64_t h, int32_t x) { return (h ^ (uint32_t) x) * 0x100000001b3ULL; }
+    static KnapsackBinaryHeader layout(int64_t n, int64_t q, uint64_t checksum);  // zero-filled, offsets set for n items
+    uint64_t padding() const;  // zero bytes between the end of the values and w_offset
+};
+static_assert(sizeof(KnapsackBinaryHeader) == KnapsackBinaryHeader::ALIGNMENT, "the arrays must start on an aligned offset");
+static_assert(sizeof(int) == sizeof(int32_t), "the binary arrays are used as int arrays");
+
+// Item data of a knapsack instance. v and w point into storage owned by the instance,
+// so an evaluator can use them without copying as long as the instance outlives it.
+class KnapsackInstance {
+private:
+    std::vector<int> v_storage, w_storage;
+    MappedFile *mapping;  // set for binary instances, v and w point into it
+    KnapsackInstance(MappedFile *mapping, const std::string &path, bool verify_checksum);
+public:
+    int n;  // item quantity
+    long long q;  // capacity
+    const int *v;  // item values
+    const int *w;  // item weights
+    KnapsackInstance(int n, long long q, std::vector<int> v, std::vector<int> w);
+    KnapsackInstance(const KnapsackInstance&) = delete;
+    KnapsackInstance& operator=(const KnapsackInstance&) = delete;
+    ~KnapsackInstance();
+    // Memory-maps the file. Text instances are parsed in place; binary ones are used as mapped,
+    // so loading them only costs the page faults of the pages later read. Throws std::runtime_error
+    // on malformed input. The checksum is only verified on request, since it reads every page.
+    static KnapsackInstance* load(const std::string &path, InstanceFormat format = InstanceFormat::AUTO, bool verify_checksum = false);
+    void save(const std::string &path) const;  // binary format
+    uint64_t checksum() const;
+};
+
+#endif // KNAPSACK_INSTANCE_H
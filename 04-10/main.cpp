@@ -3,10 +3,13 @@
 #include <fstream>
 #include <filesystem>
 #include <vector>
+#include <memory>
 #include "optimization.hpp"
 #include "knapsack.h"
 #include "neighborhood_exploration.h"
 #include "meta_heuristics.h"
+#include "telemetry.h"
+#include "configurations.h"
 
 #define INSTANCE_DIR "./tests/instances-low_dimensional"
 #define OPTIMUM_DIR "./tests/optimum-low_dimensional"
@@ -41,10 +44,18 @@ void print_solution(
             os << i << " ";
     }
     os << std::endl;
+
+    // counts since the previous print_solution
+    if (Telemetry::ENABLED) {
+        os << "Telemetry: ";
+        Telemetry::snapshot().print(os);
+        Telemetry::reset();
+    }
 }
 
 void test_instance(std::string instance_name) {
     std::cout << "Testing instance: " << instance_name << std::endl;
+    Telemetry::reset();
 
     std::ofstream test_output_file(TEST_OUTPUT_DIR + std::string("/") + instance_name + std::string(".txt"));
     if (!test_output_file.is_open()) {
@@ -52,24 +63,14 @@ void test_instance(std::string instance_name) {
         return;
     }
 
-    std::ifstream instance_file(INSTANCE_DIR + std::string("/") + instance_name);
-    if (!instance_file.is_open()) {
-        std::cerr << "Error opening instance file: " << instance_name << std::endl;
+    KnapsackInstance *instance;
+    try {
+        instance = KnapsackInstance::load(INSTANCE_DIR + std::string("/") + instance_name);
+    } catch (const std::exception &e) {
+        std::cerr << "Error loading instance file: " << e.what() << std::endl;
         return;
     }
-
-    int n, q;
-    instance_file >> n >> q;
-
-    std::vector<int> v(n), w(n);
-    for (int i = 0; i < n; ++i) {
-        instance_file >> v[i];
-    }
-    for (int i = 0; i < n; ++i) {
-        instance_file >> w[i];
-    }
-
-    instance_file.close();
+    int n = instance->n;
 
     std::ifstream optimum_file(OPTIMUM_DIR + std::string("/") + instance_name);
     long long optimum;
@@ -86,20 +87,24 @@ void test_instance(std::string instance_name) {
         test_output_file << std::setw(100) << std::setfill('-') << "" << std::endl;
     }
 
-    KnapsackEvaluator evl(n, q, v, w);
-    MovementGenerator<KnapsackSolution> *mg = new KnapsackInversionMovementGenerator(&evl, n);
+    KnapsackEvaluator evl(instance);
+    KnapsackInversionMovementGenerator mg(&evl, n);
 
     KnapsackSolution* s1;
 
-    RHRandomSelection<KnapsackSolution> rs(&evl, mg, 10000);
-    LSHillClimbing<KnapsackSolution> hill_climbing(&evl, &rs);
-    MHGrasp<KnapsackSolution> grasp(&evl,
-        [](Evaluator<KnapsackSolution> *evl, double alpha) -> KnapsackSolution* {
-            return cm_knapsack_greedy_randomized((KnapsackEvaluator*) evl, alpha, 5); 
-        },
-        0.5, &hill_climbing, 1000
-    );
-    s1 = grasp.run(600);
+    ThreadPool pool;
+    std::vector<std::unique_ptr<GraspWorker>> workers;
+    std::vector<LocalSearch<KnapsackSolution>*> ls;
+    std::vector<Random*> ls_rngs;
+    for (size_t k = 0; k < pool.size(); k++) {
+        workers.emplace_back(new GraspWorker(&evl, &mg, k + 1));
+        ls.push_back(&workers[k]->hill_climbing);
+        ls_rngs.push_back(&workers[k]->rng);
+    }
+
+    MHParallelGrasp<KnapsackSolution> grasp(&evl, cm_grasp_construction, GRASP_ALPHA, ls, ls_rngs, GRASP_MAX, &pool);
+    Budget grasp_budget(600);
+    s1 = grasp.run(&grasp_budget);
     print_solution(
         "Meta Heuristic: GRASP",
         &evl, s1, NULL, optimum, test_output_file
@@ -109,14 +114,13 @@ void test_instance(std::string instance_name) {
 
     test_output_file << std::setw(100) << std::setfill('-') << "" << std::endl;
 
-    KnapsackSolution* s = cm_knapsack_greedy_randomized(&evl, 0.9, 99999);
+    Budget construction_budget(99999);
+    KnapsackSolution* s = cm_knapsack_greedy_randomized(&evl, SA_START_ALPHA, &construction_budget);
     print_solution("Constructive Method: Greedy Randomized", &evl, s, NULL, optimum, test_output_file);
     test_output_file << std::endl;
-    MHSimulatedAnnealing<KnapsackSolution> simulated_annealing(
-        &evl, mg, s, 100000,
-        0.95, 1.05, 0.9, 0.00001
-    );
-    s1 = simulated_annealing.run(600);
+    KnapsackSimulatedAnnealing simulated_annealing = mh_simulated_annealing(&evl, &mg, s);
+    Budget simulated_annealing_budget(600);
+    s1 = simulated_annealing.run(&simulated_annealing_budget);
     print_solution(
         "Meta Heuristic: Simulated Annealing",
         &evl, s1, s, optimum, test_output_file
@@ -124,8 +128,8 @@ void test_instance(std::string instance_name) {
     delete s1;
     test_output_file << std::endl;
 
-    delete mg;
     test_output_file.close();
+    delete instance;
 }
 
 int main() {
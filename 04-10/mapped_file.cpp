@@ -0,0 +1,65 @@
+#include "mapped_file.h"
+#include <stdexcept>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+MappedFile::MappedFile(const std::string &path) {
+    this->data = nullptr;
+    this->length = 0;
+
+    this->fd = open(path.c_str(), O_RDONLY);
+    if (this->fd < 0)
+        throw std::runtime_error("Cannot open '" + path + "': " + std::strerror(errno));
+
+    struct stat st;
+    if (fstat(this->fd, &st) < 0) {
+        int error = errno;
+        close(this->fd);
+        throw std::runtime_error("Cannot stat '" + path + "': " + std::strerror(error));
+    }
+
+    if (!S_ISREG(st.st_mode)) {
+        close(this->fd);
+        throw std::runtime_error("Cannot map '" + path + "': not a regular file");
+    }
+
+    // mmap rejects empty mappings, an empty file is just an empty range
+    this->length = st.st_size;
+    if (this->length == 0) return;
+
+    void *p = mmap(nullptr, this->length, PROT_READ, MAP_PRIVATE, this->fd, 0);
+    if (p == MAP_FAILED) {
+        int error = errno;
+        close(this->fd);
+        throw std::runtime_error("Cannot map '" + path + "': " + std::strerror(error));
+    }
+
+    this->data = (const char*) p;
+}
+
+void MappedFile::advise_sequential() const {
+    if (this->data != nullptr)
+        madvise((void*) this->data, this->length, MADV_SEQUENTIAL);
+}
+
+MappedFile::~MappedFile() {
+    if (this->data != nullptr)
+        munmap((void*) this->data, this->length);
+    close(this->fd);
+}
+
+const char* MappedFile::begin() const {
+    return this->data;
+}
+
+const char* MappedFile::end() const {
+    return this->data + this->length;
+}
+
+size_t MappedFile::size() const {
+    return this->length;
+}
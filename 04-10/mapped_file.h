@@ -0,0 +1,24 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <string>
+#include <cstddef>
+
+// Read-only memory mapping of a whole file, unmapped on destruction.
+class MappedFile {
+private:
+    int fd;
+    const char *data;
+    size_t length;
+public:
+    MappedFile(const std::string &path);  // throws std::runtime_error if the file cannot be mapped
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile();
+    const char* begin() const;
+    const char* end() const;
+    size_t size() const;
+    void advise_sequential() const;  // read-ahead hint for a single front to back pass
+};
+
+#endif // MAPPED_FILE_H
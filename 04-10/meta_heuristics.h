@@ -2,62 +2,147 @@
 #define META_HEURISTICS_H
 
 #include <cmath>
+#include <iostream>
+#include <vector>
+#include <atomic>
+#include <mutex>
 #include "optimization.hpp"
 #include "neighborhood_exploration.h"
+#include "budget.h"
+#include "thread_pool.h"
+#include "metropolis.h"
+#include "telemetry.h"
+#include "trace.h"
 
 template <class SolutionClass>
 class MetaHeuristicAlgorithm {
     static_assert(std::is_base_of<Solution, SolutionClass>::value, "SolutionClass must be a descendant of Solution");
 protected:
     Evaluator<SolutionClass> *evl;
+    std::ostream *log;  // progress messages, std::cout by default
+    TraceWriter *trace;  // nullptr unless set_trace() was called
 public:
     MetaHeuristicAlgorithm(Evaluator<SolutionClass> *evl);
-    virtual SolutionClass* run(double t) = 0;
+    virtual ~MetaHeuristicAlgorithm() = default;
+    void set_log(std::ostream *log);
+    // Records the trajectory of the single-threaded searches (MHSimulatedAnnealing, MHGrasp).
+    // A writer has one producer, so it must not be shared by searches running at the same time.
+    void set_trace(TraceWriter *trace);
+    virtual SolutionClass* run(Budget *budget) = 0;  // reports each new best value through budget->improved()
 };
 
-template <class SolutionClass>
+template <class SolutionClass, class MovementClass, class GeneratorClass = MovementGenerator<SolutionClass, MovementClass>>
 class MHSimulatedAnnealing : public MetaHeuristicAlgorithm<SolutionClass> {
     static_assert(std::is_base_of<Solution, SolutionClass>::value, "SolutionClass must be a descendant of Solution");
 private:
     SolutionClass *s_0;
-    MovementGenerator<SolutionClass> *mg;
+    GeneratorClass *mg;
     int SA_max;
     double alpha;
     double beta;
     double gamma;
     double t_min;
+    Random *rng;
+    ThreadPool *pool;
+    AcceptanceMode acceptance;
 public:
     MHSimulatedAnnealing(
         Evaluator<SolutionClass> *evl,
-        MovementGenerator<SolutionClass> *mg,
+        GeneratorClass *mg,
         SolutionClass *s_0,
         int SA_max,
         double alpha = 0.95,
         double beta = 1.05,
         double gamma = 0.9,
-        double t_min = 0.00001
+        double t_min = 0.00001,
+        Random *rng = nullptr,
+        ThreadPool *pool = nullptr,  // samples the initial temperature in parallel when set
+        AcceptanceMode acceptance = AcceptanceMode::TABLE
     );
+    // Samples SA_max deltas once and bisects for the temperature at which the expected
+    // acceptance rate of the sample reaches gamma.
     double initial_temperature(const SolutionClass *s);
-    SolutionClass* run(double t) override;
+    // Original estimate: multiplies t by beta from t_min, sampling SA_max movements
+    // at each step, until more than gamma of them are accepted.
+    double heating_temperature(const SolutionClass *s);
+    SolutionClass* run(Budget *budget) override;  // charges one evaluation per sampled movement
+};
+
+// Replica exchange: one annealing chain per temperature of a ladder, run in parallel, swapping states every 'sweep' steps.
+template <class SolutionClass, class MovementClass, class GeneratorClass = MovementGenerator<SolutionClass, MovementClass>>
+class MHParallelTempering : public MetaHeuristicAlgorithm<SolutionClass> {
+    static_assert(std::is_base_of<Solution, SolutionClass>::value, "SolutionClass must be a descendant of Solution");
+private:
+    SolutionClass *s_0;
+    GeneratorClass *mg;
+    std::vector<double> temperatures;  // ascending
+    int sweep;
+    int exchanges_max;
+    ThreadPool *pool;
+    Random *rng;
+    AcceptanceMode acceptance;
+public:
+    MHParallelTempering(
+        Evaluator<SolutionClass> *evl,
+        GeneratorClass *mg,
+        SolutionClass *s_0,
+        std::vector<double> temperatures,
+        int sweep,
+        int exchanges_max,
+        ThreadPool *pool,
+        Random *rng = nullptr,
+        AcceptanceMode acceptance = AcceptanceMode::TABLE
+    );
+    static std::vector<double> geometric_ladder(double t_low, double t_high, size_t replicas);
+    SolutionClass* run(Budget *budget) override;  // charges one evaluation per sampled movement
 };
 
 template <class SolutionClass>
 class MHGrasp : public MetaHeuristicAlgorithm<SolutionClass> {
     static_assert(std::is_base_of<Solution, SolutionClass>::value, "SolutionClass must be a descendant of Solution");
 private:
-    SolutionClass* (*constructive_method)(Evaluator<SolutionClass>*, double);
+    SolutionClass* (*constructive_method)(Evaluator<SolutionClass>*, double, Budget*, Random*);
     double alpha;
     LocalSearch<SolutionClass> *ls;
     int GRASP_max;
+    Random *rng;
 public:
     MHGrasp(
         Evaluator<SolutionClass> *evl,
-        SolutionClass* (*constructive_method)(Evaluator<SolutionClass>*, double),
+        SolutionClass* (*constructive_method)(Evaluator<SolutionClass>*, double, Budget*, Random*),
         double alpha,
         LocalSearch<SolutionClass> *ls,
-        int GRASP_max
+        int GRASP_max,
+        Random *rng = nullptr
+    );
+    SolutionClass* run(Budget *budget) override;
+};
+
+// GRASP iterations spread over a thread pool; ls[k] and ls_rngs[k] belong to worker k, and the
+// generator is reseeded from (seed, iteration) so a run is reproducible from rng.
+template <class SolutionClass>
+class MHParallelGrasp : public MetaHeuristicAlgorithm<SolutionClass> {
+    static_assert(std::is_base_of<Solution, SolutionClass>::value, "SolutionClass must be a descendant of Solution");
+private:
+    SolutionClass* (*constructive_method)(Evaluator<SolutionClass>*, double, Budget*, Random*);
+    double alpha;
+    std::vector<LocalSearch<SolutionClass>*> ls;
+    std::vector<Random*> ls_rngs;
+    int GRASP_max;
+    ThreadPool *pool;
+    Random *rng;
+public:
+    MHParallelGrasp(
+        Evaluator<SolutionClass> *evl,
+        SolutionClass* (*constructive_method)(Evaluator<SolutionClass>*, double, Budget*, Random*),
+        double alpha,
+        std::vector<LocalSearch<SolutionClass>*> ls,  // one per worker
+        std::vector<Random*> ls_rngs,  // the generator of each ls[k]
+        int GRASP_max,
+        ThreadPool *pool,
+        Random *rng = nullptr
     );
-    SolutionClass* run(double t) override;
+    SolutionClass* run(Budget *budget) override;
 };
 
 #include "meta_heuristics.tpp"
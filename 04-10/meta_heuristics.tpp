@@ -3,18 +3,33 @@
 template <class SolutionClass>
 MetaHeuristicAlgorithm<SolutionClass>::MetaHeuristicAlgorithm(Evaluator<SolutionClass> *evl) {
     this->evl = evl;
+    this->log = &std::cout;
+    this->trace = nullptr;
 }
 
 template <class SolutionClass>
-MHSimulatedAnnealing<SolutionClass>::MHSimulatedAnnealing(
+void MetaHeuristicAlgorithm<SolutionClass>::set_log(std::ostream *log) {
+    this->log = log;
+}
+
+template <class SolutionClass>
+void MetaHeuristicAlgorithm<SolutionClass>::set_trace(TraceWriter *trace) {
+    this->trace = trace;
+}
+
+template <class SolutionClass, class MovementClass, class GeneratorClass>
+MHSimulatedAnnealing<SolutionClass, MovementClass, GeneratorClass>::MHSimulatedAnnealing(
     Evaluator<SolutionClass> *evl,
-    MovementGenerator<SolutionClass> *mg,
+    GeneratorClass *mg,
     SolutionClass *s_0,
     int SA_max,
     double alpha,
     double beta,
     double gamma,
-    double t_min
+    double t_min,
+    Random *rng,
+    ThreadPool *pool,
+    AcceptanceMode acceptance
 )
     : MetaHeuristicAlgorithm<SolutionClass>(evl)
 {
@@ -34,20 +49,74 @@ MHSimulatedAnnealing<SolutionClass>::MHSimulatedAnnealing(
     this->beta = beta;
     this->gamma = gamma;
     this->t_min = t_min;
+    this->rng = Random::or_default(rng);
+    this->pool = pool;
+    this->acceptance = acceptance;
 }
 
-template <class SolutionClass>
-double MHSimulatedAnnealing<SolutionClass>::initial_temperature(const SolutionClass *s) {
-    double curr_t = this->t_min;
+template <class SolutionClass, class MovementClass, class GeneratorClass>
+double MHSimulatedAnnealing<SolutionClass, MovementClass, GeneratorClass>::initial_temperature(const SolutionClass *s) {
+    const size_t samples = this->SA_max;
+    std::vector<long long> deltas(samples);
+
+    if (this->pool != nullptr && samples > 0) {
+        // deltas may build caches inside s, so fill them before s is shared
+        this->mg->at(0).delta(s);
+
+        const uint64_t seed = this->rng->next();
+        const size_t chunks = this->pool->size();
+        this->pool->parallel_for(chunks, [&](size_t c) {
+            Random chunk_rng(seed, c);
+            for (size_t k = c * samples / chunks; k < (c + 1) * samples / chunks; k++)
+                deltas[k] = this->mg->get_random(&chunk_rng).delta(s);
+        });
+    } else {
+        for (size_t k = 0; k < samples; k++)
+            deltas[k] = this->mg->get_random(this->rng).delta(s);
+    }
+
+    // movements that do not worsen s are always accepted, the others with probability exp(delta / t)
+    std::vector<double> worsening;
+    for (long long delta : deltas) {
+        if (delta < 0) worsening.push_back((double) delta);
+    }
+    if (worsening.empty()) return this->t_min;
+
+    const double target = this->gamma * samples;
+    auto expected_accepted = [&](double t) {
+        double accepted = samples - worsening.size();
+        for (double delta : worsening)
+            accepted += std::exp(delta / t);
+        return accepted;
+    };
+
+    // at t_high even the worst sampled movement is accepted with probability gamma
+    double t_low = this->t_min,
+           t_high = std::max(this->t_min, *std::min_element(worsening.begin(), worsening.end()) / std::log(this->gamma));
+    if (expected_accepted(t_low) >= target) return t_low;
+
+    // the acceptance rate grows with t, so bisect (geometrically, t spans many orders of magnitude)
+    for (int i = 0; i < 64 && t_high > t_low * (1 + 1e-6); i++) {
+        double t = std::sqrt(t_low * t_high);
+        if (expected_accepted(t) >= target) t_high = t;
+        else t_low = t;
+    }
+
+    return t_high;
+}
+
+template <class SolutionClass, class MovementClass, class GeneratorClass>
+double MHSimulatedAnnealing<SolutionClass, MovementClass, GeneratorClass>::heating_temperature(const SolutionClass *s) {
+    MetropolisCriterion metropolis(this->acceptance, this->t_min);
 
     while (true) {
         int curr_accepted = 0;
 
         for (int i=0; i<this->SA_max; i++) {
-            Movement<SolutionClass> *m = this->mg->get_random();
+            MovementClass m = this->mg->get_random(this->rng);
 
-            long long delta = m->delta(s);
-            if (delta > 0 || std::rand() / (double) RAND_MAX < std::exp(delta / curr_t)) {
+            long long delta = m.delta(s);
+            if (metropolis.accept(delta, this->rng)) {
                 curr_accepted++;
             }
         }        
@@ -55,70 +124,223 @@ double MHSimulatedAnnealing<SolutionClass>::initial_temperature(const SolutionCl
         if (curr_accepted > this->SA_max * this->gamma)
             break;
 
-        curr_t = this->beta * curr_t;
+        metropolis.set_temperature(this->beta * metropolis.get_temperature());
     }
 
-    return curr_t;
+    return metropolis.get_temperature();
 }
 
-template <class SolutionClass>
-SolutionClass* MHSimulatedAnnealing<SolutionClass>::run(double t) {
-    auto start = std::chrono::high_resolution_clock::now();
-
+template <class SolutionClass, class MovementClass, class GeneratorClass>
+SolutionClass* MHSimulatedAnnealing<SolutionClass, MovementClass, GeneratorClass>::run(Budget *budget) {
     SolutionClass *s_prime = (SolutionClass*) this->s_0->clone();
     SolutionClass *s_curr = (SolutionClass*) this->s_0->clone();
 
+    budget->improved(this->evl->get_evaluation(s_prime));
+
     double curr_t = this->initial_temperature(this->s_0);
-    std::cout << "Simulated Annealing starting with t_0 = " << curr_t << "." << std::endl;
+    *this->log << "Simulated Annealing starting with t_0 = " << curr_t << "." << std::endl;
 
+    MetropolisCriterion metropolis(this->acceptance);
+    long long iteration = 0;
     while (curr_t > this->t_min) {
-        auto current = std::chrono::high_resolution_clock::now();
-        if (std::chrono::duration<double>(current - start).count() >= t) {
-            std::cout << "> Simulated Annealing finished by time." << std::endl;
+        metropolis.set_temperature(curr_t);
+        Telemetry::count(TelemetryCounter::TEMPERATURE_LEVELS);
+
+        if (budget->expired()) {
+            *this->log << "> Simulated Annealing finished by budget." << std::endl;
             break;
         }
 
         for (int i=0; i<this->SA_max; i++) {
-            current = std::chrono::high_resolution_clock::now();
-            if (std::chrono::duration<double>(current - start).count() >= t) break;            
-
-            Movement<SolutionClass> *m = this->mg->get_random();
-            if (m == NULL) break;
-            
-            long long delta = m->delta(s_curr);
-            if (delta > 0 || std::rand() / (double) RAND_MAX < std::exp(delta / curr_t)) {
-                SolutionClass *s1 = (SolutionClass*) s_curr->clone();
-                m->move(s1);
-                delete s_curr;
-                s_curr = s1;
+            if (budget->expired()) break;
+            budget->charge();
+
+            MovementClass m = this->mg->get_random(this->rng);
+
+            long long delta = m.delta(s_curr);
+            bool improved = false;
+            if (metropolis.accept(delta, this->rng)) {
+                m.move(s_curr);
+                Telemetry::count(TelemetryCounter::ACCEPTED);
+                Telemetry::count(TelemetryCounter::MOVES);
 
                 if (this->evl->get_evaluation(s_curr) > this->evl->get_evaluation(s_prime)) {
-                    delete s_prime;
-                    s_prime = (SolutionClass*) s_curr->clone();
+                    s_prime->copy_from(s_curr);
+                    budget->improved(this->evl->get_evaluation(s_prime));
+                    improved = true;
                 }
+            } else {
+                Telemetry::count(TelemetryCounter::REJECTED);
             }
 
-            delete m;
+            if (this->trace != nullptr) {
+                this->trace->record(TraceKind::SA_STEP, iteration, this->evl->get_evaluation(s_curr),
+                                    this->evl->get_evaluation(s_prime), curr_t, improved);
+            }
+            iteration++;
         }
 
         curr_t = this->alpha * curr_t;
     }
 
-    auto current = std::chrono::high_resolution_clock::now();
-    auto total_time = std::chrono::duration<double>(current - start).count();
-    std::cout << "Simulated Annealing finished after " << total_time << " seconds." << std::endl;
+    *this->log << "Simulated Annealing finished after " << budget->elapsed() << " seconds." << std::endl;
 
     delete s_curr;
     return s_prime;
 }
 
+template <class SolutionClass, class MovementClass, class GeneratorClass>
+MHParallelTempering<SolutionClass, MovementClass, GeneratorClass>::MHParallelTempering(
+    Evaluator<SolutionClass> *evl,
+    GeneratorClass *mg,
+    SolutionClass *s_0,
+    std::vector<double> temperatures,
+    int sweep,
+    int exchanges_max,
+    ThreadPool *pool,
+    Random *rng,
+    AcceptanceMode acceptance
+)
+    : MetaHeuristicAlgorithm<SolutionClass>(evl)
+{
+    if (temperatures.empty())
+        throw std::invalid_argument("Parameter 'temperatures' must hold at least one temperature.");
+
+    for (double t : temperatures) {
+        if (t <= 0)
+            throw std::invalid_argument("Parameter 'temperatures' must only hold values greater than 0.");
+    }
+
+    if (sweep <= 0)
+        throw std::invalid_argument("Parameter 'sweep' must be greater than 0.");
+
+    std::sort(temperatures.begin(), temperatures.end());
+
+    this->mg = mg;
+    this->s_0 = s_0;
+    this->temperatures = temperatures;
+    this->sweep = sweep;
+    this->exchanges_max = exchanges_max;
+    this->pool = pool;
+    this->rng = Random::or_default(rng);
+    this->acceptance = acceptance;
+}
+
+template <class SolutionClass, class MovementClass, class GeneratorClass>
+std::vector<double> MHParallelTempering<SolutionClass, MovementClass, GeneratorClass>::geometric_ladder(double t_low, double t_high, size_t replicas) {
+    std::vector<double> temperatures;
+    for (size_t r = 0; r < replicas; r++) {
+        double x = (replicas > 1) ? r / (double) (replicas - 1) : 0;
+        temperatures.push_back(t_low * std::pow(t_high / t_low, x));
+    }
+    return temperatures;
+}
+
+template <class SolutionClass, class MovementClass, class GeneratorClass>
+SolutionClass* MHParallelTempering<SolutionClass, MovementClass, GeneratorClass>::run(Budget *budget) {
+    const size_t replicas = this->temperatures.size();
+    const uint64_t seed = this->rng->next();
+
+    // chain r always runs at temperatures[r]; exchanges swap the states between chains
+    std::vector<SolutionClass*> states(replicas), bests(replicas);
+    // a generator's state is written on every sample, so each chain keeps its own cache lines
+    struct alignas(64) Chain {
+        Random rng;
+        MetropolisCriterion criterion;
+    };
+    std::vector<Chain> chains;
+    chains.reserve(replicas);
+    for (size_t r = 0; r < replicas; r++) {
+        states[r] = (SolutionClass*) this->s_0->clone();
+        bests[r] = (SolutionClass*) this->s_0->clone();
+        chains.push_back({ Random(seed, r), MetropolisCriterion(this->acceptance, this->temperatures[r]) });
+    }
+    SolutionClass *s_prime = (SolutionClass*) this->s_0->clone();
+    budget->improved(this->evl->get_evaluation(s_prime));
+
+    *this->log << "Parallel Tempering starting with " << replicas << " replicas, t = ["
+              << this->temperatures.front() << ", " << this->temperatures.back() << "]." << std::endl;
+
+    auto chain = [&](size_t r) {
+        Budget chain_budget(budget);
+        SolutionClass *s_curr = states[r];
+        Random *chain_rng = &chains[r].rng;
+        MetropolisCriterion *criterion = &chains[r].criterion;
+
+        for (int i=0; i<this->sweep; i++) {
+            if (chain_budget.expired()) break;
+            chain_budget.charge();
+
+            MovementClass m = this->mg->get_random(chain_rng);
+
+            long long delta = m.delta(s_curr);
+            if (criterion->accept(delta, chain_rng)) {
+                m.move(s_curr);
+                Telemetry::count(TelemetryCounter::ACCEPTED);
+                Telemetry::count(TelemetryCounter::MOVES);
+
+                if (this->evl->get_evaluation(s_curr) > this->evl->get_evaluation(bests[r])) {
+                    bests[r]->copy_from(s_curr);
+                    chain_budget.improved(this->evl->get_evaluation(bests[r]));
+                }
+            } else {
+                Telemetry::count(TelemetryCounter::REJECTED);
+            }
+        }
+    };
+
+    long long attempted = 0, accepted = 0;
+    int exchange = 0;
+    for (; exchange<this->exchanges_max; exchange++) {
+        if (budget->expired_now()) {
+            *this->log << "> Parallel Tempering finished by budget." << std::endl;
+            break;
+        }
+
+        if (this->pool != nullptr) {
+            this->pool->parallel_for(replicas, chain);
+        } else {
+            for (size_t r = 0; r < replicas; r++)
+                chain(r);
+        }
+
+        for (size_t r = 0; r < replicas; r++) {
+            if (this->evl->get_evaluation(bests[r]) > this->evl->get_evaluation(s_prime))
+                s_prime->copy_from(bests[r]);
+        }
+
+        // alternating even and odd pairs lets every state travel along the whole ladder
+        for (size_t r = exchange % 2; r + 1 < replicas; r += 2) {
+            double e_i = (double) this->evl->get_evaluation(states[r]),
+                   e_j = (double) this->evl->get_evaluation(states[r + 1]);
+            double x = (e_j - e_i) * (1 / this->temperatures[r] - 1 / this->temperatures[r + 1]);
+
+            attempted++;
+            if (x >= 0 || this->rng->uniform_real() < std::exp(x)) {
+                std::swap(states[r], states[r + 1]);
+                accepted++;
+            }
+        }
+    }
+
+    *this->log << "Parallel Tempering finished after " << budget->elapsed() << " seconds, " << exchange
+              << " exchange rounds and " << accepted << "/" << attempted << " accepted swaps." << std::endl;
+
+    for (size_t r = 0; r < replicas; r++) {
+        delete states[r];
+        delete bests[r];
+    }
+    return s_prime;
+}
+
 template <class SolutionClass>
 MHGrasp<SolutionClass>::MHGrasp(
     Evaluator<SolutionClass> *evl,
-    SolutionClass* (*constructive_method)(Evaluator<SolutionClass>*, double),
+    SolutionClass* (*constructive_method)(Evaluator<SolutionClass>*, double, Budget*, Random*),
     double alpha,
     LocalSearch<SolutionClass> *ls,
-    int GRASP_max
+    int GRASP_max,
+    Random *rng
 )
     : MetaHeuristicAlgorithm<SolutionClass>(evl)
 {
@@ -126,41 +348,147 @@ MHGrasp<SolutionClass>::MHGrasp(
     this->alpha = alpha;
     this->ls = ls;
     this->GRASP_max = GRASP_max;
+    this->rng = Random::or_default(rng);
 }
 
 template <class SolutionClass>
-SolutionClass* MHGrasp<SolutionClass>::run(double t) {
-    auto start = std::chrono::high_resolution_clock::now();
-
-    std::cout << "GRASP starting." << std::endl;
+SolutionClass* MHGrasp<SolutionClass>::run(Budget *budget) {
+    *this->log << "GRASP starting." << std::endl;
 
-    SolutionClass *s_tmp = this->constructive_method(this->evl, this->alpha);
-    SolutionClass *s_prime = this->ls->run(s_tmp, t);
+    // construction and local search draw from the run's budget, so each phase only gets what is left
+    SolutionClass *s_tmp = this->constructive_method(this->evl, this->alpha, budget, this->rng);
+    Telemetry::count(TelemetryCounter::CONSTRUCTIONS);
+    SolutionClass *s_prime = this->ls->run(s_tmp, budget);
     delete s_tmp;
+    budget->improved(this->evl->get_evaluation(s_prime));
+    if (this->trace != nullptr) {
+        long long value = this->evl->get_evaluation(s_prime);
+        this->trace->record(TraceKind::GRASP_ITERATION, 0, value, value, 0, true);
+    }
 
     int GRASP_curr = 0;
     for (; GRASP_curr<this->GRASP_max; GRASP_curr++) {
-        auto current = std::chrono::high_resolution_clock::now();
-        if (std::chrono::duration<double>(current - start).count() >= t) {
-            std::cout << "> GRASP finished by time." << std::endl;
+        if (budget->expired_now()) {
+            *this->log << "> GRASP finished by budget." << std::endl;
             break;
         }
 
-        s_tmp = this->constructive_method(this->evl, this->alpha);
-        SolutionClass *s1 = this->ls->run(s_tmp, t);
+        s_tmp = this->constructive_method(this->evl, this->alpha, budget, this->rng);
+        Telemetry::count(TelemetryCounter::CONSTRUCTIONS);
+        SolutionClass *s1 = this->ls->run(s_tmp, budget);
         delete s_tmp;
 
-        if (this->evl->get_evaluation(s1) > this->evl->get_evaluation(s_prime)) {
+        long long value = this->evl->get_evaluation(s1);
+        bool improved = value > this->evl->get_evaluation(s_prime);
+        if (this->trace != nullptr) {
+            this->trace->record(TraceKind::GRASP_ITERATION, GRASP_curr + 1, value,
+                                std::max(value, this->evl->get_evaluation(s_prime)), 0, improved);
+        }
+
+        if (improved) {
             delete s_prime;
             s_prime = s1;
+            budget->improved(this->evl->get_evaluation(s_prime));
         } else {
             delete s1;
         }
     }
 
-    auto current = std::chrono::high_resolution_clock::now();
-    auto total_time = std::chrono::duration<double>(current - start).count();
-    std::cout << "GRASP finished after " << total_time << " seconds and " << GRASP_curr << " iterations." << std::endl;
+    *this->log << "GRASP finished after " << budget->elapsed() << " seconds and " << GRASP_curr << " iterations." << std::endl;
+
+    return s_prime;
+}
+
+template <class SolutionClass>
+MHParallelGrasp<SolutionClass>::MHParallelGrasp(
+    Evaluator<SolutionClass> *evl,
+    SolutionClass* (*constructive_method)(Evaluator<SolutionClass>*, double, Budget*, Random*),
+    double alpha,
+    std::vector<LocalSearch<SolutionClass>*> ls,
+    std::vector<Random*> ls_rngs,
+    int GRASP_max,
+    ThreadPool *pool,
+    Random *rng
+)
+    : MetaHeuristicAlgorithm<SolutionClass>(evl)
+{
+    if (ls.empty())
+        throw std::invalid_argument("Parameter 'ls' must hold at least one local search.");
+
+    if (ls_rngs.size() != ls.size())
+        throw std::invalid_argument("Parameter 'ls_rngs' must hold one generator per local search.");
+
+    this->constructive_method = constructive_method;
+    this->alpha = alpha;
+    this->ls = ls;
+    this->ls_rngs = ls_rngs;
+    this->GRASP_max = GRASP_max;
+    this->pool = pool;
+    this->rng = Random::or_default(rng);
+}
+
+template <class SolutionClass>
+SolutionClass* MHParallelGrasp<SolutionClass>::run(Budget *budget) {
+    *this->log << "Parallel GRASP starting with " << this->ls.size() << " workers." << std::endl;
+
+    // like the sequential version: one initial iteration plus GRASP_max more
+    const long long total = (long long) this->GRASP_max + 1;
+    const uint64_t seed = this->rng->next();
+
+    std::atomic<long long> next_iteration(0), completed(0);
+    std::atomic<long long> best_value(std::numeric_limits<long long>::min());
+    std::mutex best_mutex;
+    SolutionClass *s_prime = nullptr;
+    long long best_iteration = -1;
+
+    auto worker = [&](size_t k) {
+        Random *worker_rng = this->ls_rngs[k];
+        Budget worker_budget(budget);
+
+        long long iteration;
+        while ((iteration = next_iteration.fetch_add(1)) < total) {
+            // the first iteration always runs so that there is a solution to return
+            if (iteration > 0 && worker_budget.expired_now()) break;
+
+            // seed() runs the value through splitmix64, so consecutive iterations get unrelated streams
+            worker_rng->seed(seed + iteration);
+
+            SolutionClass *s_tmp = this->constructive_method(this->evl, this->alpha, &worker_budget, worker_rng);
+            Telemetry::count(TelemetryCounter::CONSTRUCTIONS);
+            SolutionClass *s1 = this->ls[k]->run(s_tmp, &worker_budget);
+            delete s_tmp;
+            completed++;
+
+            // strictly worse solutions skip the lock; ties go through it so that even a punished
+            // first solution is stored, and so that the earliest iteration wins whichever thread ran it
+            long long value = this->evl->get_evaluation(s1);
+            if (value < best_value.load(std::memory_order_acquire)) {
+                delete s1;
+                continue;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(best_mutex);
+                long long incumbent = (s_prime != nullptr) ? this->evl->get_evaluation(s_prime) : 0;
+                if (s_prime == nullptr || value > incumbent || (value == incumbent && iteration < best_iteration)) {
+                    std::swap(s_prime, s1);
+                    best_iteration = iteration;
+                    best_value.store(value, std::memory_order_release);
+                    worker_budget.improved(value);
+                }
+            }
+            delete s1;
+        }
+    };
+
+    if (this->pool != nullptr) {
+        this->pool->parallel_for(this->ls.size(), worker);
+    } else {
+        for (size_t k = 0; k < this->ls.size(); k++)
+            worker(k);
+    }
+
+    *this->log << "Parallel GRASP finished after " << budget->elapsed() << " seconds and " << completed.load() << " iterations." << std::endl;
 
     return s_prime;
 }
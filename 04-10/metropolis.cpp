@@ -0,0 +1,26 @@
+#include "metropolis.h"
+#include <algorithm>
+
+MetropolisCriterion::MetropolisCriterion(AcceptanceMode mode, double t) {
+    this->mode = mode;
+    this->set_temperature(t);
+}
+
+void MetropolisCriterion::set_temperature(double t) {
+    this->t = t;
+    this->thresholds.clear();
+    if (this->mode != AcceptanceMode::TABLE) return;
+
+    // past -t * 53 ln 2 every threshold is at most 1, so the table would add nothing
+    double useful = std::ceil(t * 53 * std::log(2.0)) + 1;
+    size_t size = (useful < MAX_TABLE_SIZE) ? (size_t) useful : MAX_TABLE_SIZE;
+
+    for (size_t k = 0; k < size; k++) {
+        long long delta = -(long long) k;
+        this->thresholds.push_back((uint64_t) std::ceil(std::exp(delta / t) * 0x1.0p53));
+    }
+}
+
+double MetropolisCriterion::get_temperature() const {
+    return this->t;
+}
@@ -0,0 +1,34 @@
+#ifndef METROPOLIS_H
+#define METROPOLIS_H
+
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include "random.h"
+
+enum class AcceptanceMode {
+    EXP,   // computes exp(delta / t) for every worsening movement
+    TABLE  // looks up precomputed thresholds for small integer deltas, same decisions as EXP
+};
+
+// Metropolis acceptance for integer deltas of a maximization problem: movements that do not
+// worsen the solution are taken, the others with probability exp(delta / t).
+// In TABLE mode set_temperature() stores ceil(exp(-k / t) * 2^53) for the first deltas -k,
+// so accept() compares the 53 random bits of uniform_real() against an integer threshold.
+// Both modes draw the same random numbers and make the same decisions.
+class MetropolisCriterion {
+private:
+    static const size_t MAX_TABLE_SIZE = 4096;  // 32 KB
+    AcceptanceMode mode;
+    double t;
+    std::vector<uint64_t> thresholds;
+public:
+    MetropolisCriterion(AcceptanceMode mode = AcceptanceMode::TABLE, double t = 1);
+    void set_temperature(double t);  // O(table size), call once per temperature level
+    double get_temperature() const;
+    inline bool accept(long long delta, Random *rng) const;
+};
+
+#include "metropolis.tpp"
+
+#endif // METROPOLIS_H
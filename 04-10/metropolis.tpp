@@ -0,0 +1,11 @@
+#include "metropolis.h"
+
+inline bool MetropolisCriterion::accept(long long delta, Random *rng) const {
+    if (delta > 0) return true;
+
+    unsigned long long k = 0ULL - (unsigned long long) delta;  // -delta, also for LLONG_MIN
+    if (k < this->thresholds.size())
+        return (rng->next() >> 11) < this->thresholds[k];
+
+    return rng->uniform_real() < std::exp(delta / this->t);
+}
@@ -5,91 +5,161 @@
 #include <algorithm>
 #include <cstdlib>
 #include <functional>
+#include <atomic>
+#include <limits>
 #include "optimization.hpp"
+#include "thread_pool.h"
+#include "budget.h"
+#include "telemetry.h"
 
-template <typename SolutionClass>
+template <typename SolutionClass, typename MovementClass, typename GeneratorClass = MovementGenerator<SolutionClass, MovementClass>>
 class NeighborhoodExplorationMethod {
     static_assert(std::is_base_of<Solution, SolutionClass>::value, "SolutionClass must be a descendant of Solution");
 public:
     Evaluator<SolutionClass> *evl;
-    MovementGenerator<SolutionClass> *mg;
-    NeighborhoodExplorationMethod(Evaluator<SolutionClass> *evl, MovementGenerator<SolutionClass> *mg);
-    virtual Movement<SolutionClass>* get_movement(const SolutionClass *s) = 0;
+    GeneratorClass *mg;
+    NeighborhoodExplorationMethod(Evaluator<SolutionClass> *evl, GeneratorClass *mg);
+    virtual bool get_movement(const SolutionClass *s, MovementClass *m) = 0;  // false if no movement was found
 };
 
-template <typename SolutionClass>
-class NEFindAny : public NeighborhoodExplorationMethod<SolutionClass> {
+template <typename SolutionClass, typename MovementClass, typename GeneratorClass = MovementGenerator<SolutionClass, MovementClass>>
+class NEFindAny : public NeighborhoodExplorationMethod<SolutionClass, MovementClass, GeneratorClass> {
     static_assert(std::is_base_of<Solution, SolutionClass>::value, "SolutionClass must be a descendant of Solution");
 private:
     int k;
+    Random *rng;
 public:
-    NEFindAny(Evaluator<SolutionClass> *evl, MovementGenerator<SolutionClass> *mg, int k);
-    Movement<SolutionClass>* get_movement(const SolutionClass *s) override;
+    NEFindAny(Evaluator<SolutionClass> *evl, GeneratorClass *mg, int k, Random *rng = nullptr);
+    bool get_movement(const SolutionClass *s, MovementClass *m) override;
 };
 
-template <typename SolutionClass>
-class NEFindFirst : public NeighborhoodExplorationMethod<SolutionClass> {
+template <typename SolutionClass, typename MovementClass, typename GeneratorClass = MovementGenerator<SolutionClass, MovementClass>>
+class NEFindFirst : public NeighborhoodExplorationMethod<SolutionClass, MovementClass, GeneratorClass> {
     static_assert(std::is_base_of<Solution, SolutionClass>::value, "SolutionClass must be a descendant of Solution");
 public:
-    NEFindFirst(Evaluator<SolutionClass> *evl, MovementGenerator<SolutionClass> *mg);
-    Movement<SolutionClass>* get_movement(const SolutionClass *s) override;
+    NEFindFirst(Evaluator<SolutionClass> *evl, GeneratorClass *mg);
+    bool get_movement(const SolutionClass *s, MovementClass *m) override;
 };
 
-template <typename SolutionClass>
-class NEFindNext : public NeighborhoodExplorationMethod<SolutionClass> {
+template <typename SolutionClass, typename MovementClass, typename GeneratorClass = MovementGenerator<SolutionClass, MovementClass>>
+class NEFindNext : public NeighborhoodExplorationMethod<SolutionClass, MovementClass, GeneratorClass> {
     static_assert(std::is_base_of<Solution, SolutionClass>::value, "SolutionClass must be a descendant of Solution");
 private:
     int j;
 public:
-    NEFindNext(Evaluator<SolutionClass> *evl, MovementGenerator<SolutionClass> *mg, int j);
-    Movement<SolutionClass>* get_movement(const SolutionClass *s) override;
+    NEFindNext(Evaluator<SolutionClass> *evl, GeneratorClass *mg, int j);
+    bool get_movement(const SolutionClass *s, MovementClass *m) override;
 };
 
-template <typename SolutionClass>
-class NEFindBest : public NeighborhoodExplorationMethod<SolutionClass> {
+template <typename SolutionClass, typename MovementClass, typename GeneratorClass = MovementGenerator<SolutionClass, MovementClass>>
+class NEFindBest : public NeighborhoodExplorationMethod<SolutionClass, MovementClass, GeneratorClass> {
     static_assert(std::is_base_of<Solution, SolutionClass>::value, "SolutionClass must be a descendant of Solution");
 public:
-    NEFindBest(Evaluator<SolutionClass> *evl, MovementGenerator<SolutionClass> *mg);
-    Movement<SolutionClass>* get_movement(const SolutionClass *s) override;
+    NEFindBest(Evaluator<SolutionClass> *evl, GeneratorClass *mg);
+    bool get_movement(const SolutionClass *s, MovementClass *m) override;
 };
 
-template <typename SolutionClass>
-std::vector<SolutionClass*> all_neighbors(SolutionClass *s, MovementGenerator<SolutionClass> *mg);
+// Best improvement over the whole neighborhood, split into contiguous chunks scanned by a thread pool.
+// Ties are resolved towards the lowest index, so it returns the same movement as NEFindBest.
+template <typename SolutionClass, typename MovementClass, typename GeneratorClass = MovementGenerator<SolutionClass, MovementClass>>
+class NEParallelFindBest : public NeighborhoodExplorationMethod<SolutionClass, MovementClass, GeneratorClass> {
+    static_assert(std::is_base_of<Solution, SolutionClass>::value, "SolutionClass must be a descendant of Solution");
+private:
+    ThreadPool *pool;
+    size_t chunks_per_thread;
+public:
+    NEParallelFindBest(Evaluator<SolutionClass> *evl, GeneratorClass *mg, ThreadPool *pool, size_t chunks_per_thread = 4);
+    bool get_movement(const SolutionClass *s, MovementClass *m) override;
+};
+
+enum class FirstImprovementOrder {
+    LOWEST_INDEX,  // same movement as the sequential scan
+    FIRST_FOUND    // whichever worker finds an improvement first, stops sooner
+};
+
+// First improvement with workers scanning disjoint slices of the neighborhood.
+// Once an improving movement is found the other workers stop through a shared atomic.
+template <typename SolutionClass, typename MovementClass, typename GeneratorClass = MovementGenerator<SolutionClass, MovementClass>>
+class NEParallelFindFirst : public NeighborhoodExplorationMethod<SolutionClass, MovementClass, GeneratorClass> {
+    static_assert(std::is_base_of<Solution, SolutionClass>::value, "SolutionClass must be a descendant of Solution");
+private:
+    ThreadPool *pool;
+    FirstImprovementOrder order;
+    size_t chunks_per_thread;
+public:
+    NEParallelFindFirst(
+        Evaluator<SolutionClass> *evl,
+        GeneratorClass *mg,
+        ThreadPool *pool,
+        FirstImprovementOrder order = FirstImprovementOrder::LOWEST_INDEX,
+        size_t chunks_per_thread = 64
+    );
+    bool get_movement(const SolutionClass *s, MovementClass *m) override;
+};
+
+template <typename SolutionClass, typename MovementClass, typename GeneratorClass = MovementGenerator<SolutionClass, MovementClass>>
+std::vector<SolutionClass*> all_neighbors(SolutionClass *s, GeneratorClass *mg);
 
 template <typename SolutionClass>
 class RefinementHeuristicsMethod {
     static_assert(std::is_base_of<Solution, SolutionClass>::value, "SolutionClass must be a descendant of Solution");
 public:
     Evaluator<SolutionClass> *evl;
-    MovementGenerator<SolutionClass> *mg;
-    RefinementHeuristicsMethod(Evaluator<SolutionClass> *evl, MovementGenerator<SolutionClass> *mg);
-    virtual SolutionClass* run(const SolutionClass *s) = 0;
+    RefinementHeuristicsMethod(Evaluator<SolutionClass> *evl);
+    virtual ~RefinementHeuristicsMethod() = default;
+    virtual bool refine(SolutionClass *s) = 0;  // moves s in place, false if no movement was found
+    SolutionClass* run(const SolutionClass *s);
 };
 
-template <typename SolutionClass>
+template <typename SolutionClass, typename MovementClass, typename GeneratorClass = MovementGenerator<SolutionClass, MovementClass>>
 class RHRandomSelection : public RefinementHeuristicsMethod<SolutionClass> {
     static_assert(std::is_base_of<Solution, SolutionClass>::value, "SolutionClass must be a descendant of Solution");
 private:
     int k;
+    Random *rng;
 public:
-    RHRandomSelection(Evaluator<SolutionClass> *evl, MovementGenerator<SolutionClass> *mg, int k);
-    SolutionClass* run(const SolutionClass *s) override;
+    GeneratorClass *mg;
+    RHRandomSelection(Evaluator<SolutionClass> *evl, GeneratorClass *mg, int k, Random *rng = nullptr);
+    bool refine(SolutionClass *s) override;
 };
 
-template <typename SolutionClass>
+template <typename SolutionClass, typename MovementClass, typename GeneratorClass = MovementGenerator<SolutionClass, MovementClass>>
 class RHFirstImprovement : public RefinementHeuristicsMethod<SolutionClass> {
     static_assert(std::is_base_of<Solution, SolutionClass>::value, "SolutionClass must be a descendant of Solution");
 public:
-    RHFirstImprovement(Evaluator<SolutionClass> *evl, MovementGenerator<SolutionClass> *mg);
-    SolutionClass* run(const SolutionClass *s) override;
+    GeneratorClass *mg;
+    ThreadPool *pool;  // scans the neighborhood in parallel when set
+    FirstImprovementOrder order;
+    RHFirstImprovement(
+        Evaluator<SolutionClass> *evl,
+        GeneratorClass *mg,
+        ThreadPool *pool = nullptr,
+        FirstImprovementOrder order = FirstImprovementOrder::LOWEST_INDEX
+    );
+    bool refine(SolutionClass *s) override;
 };
 
-template <typename SolutionClass>
+// Next improvement: every call resumes the scan right after the last improving movement,
+// wrapping around at the end, and fails only after a full cycle without improvement.
+template <typename SolutionClass, typename MovementClass, typename GeneratorClass = MovementGenerator<SolutionClass, MovementClass>>
+class RHNextImprovement : public RefinementHeuristicsMethod<SolutionClass> {
+    static_assert(std::is_base_of<Solution, SolutionClass>::value, "SolutionClass must be a descendant of Solution");
+private:
+    size_t position;
+public:
+    GeneratorClass *mg;
+    RHNextImprovement(Evaluator<SolutionClass> *evl, GeneratorClass *mg);
+    bool refine(SolutionClass *s) override;
+};
+
+template <typename SolutionClass, typename MovementClass, typename GeneratorClass = MovementGenerator<SolutionClass, MovementClass>>
 class RHBestImprovement : public RefinementHeuristicsMethod<SolutionClass> {
     static_assert(std::is_base_of<Solution, SolutionClass>::value, "SolutionClass must be a descendant of Solution");
 public:
-    RHBestImprovement(Evaluator<SolutionClass> *evl, MovementGenerator<SolutionClass> *mg);
-    SolutionClass* run(const SolutionClass *s) override;
+    GeneratorClass *mg;
+    ThreadPool *pool;  // scans the neighborhood in parallel when set
+    RHBestImprovement(Evaluator<SolutionClass> *evl, GeneratorClass *mg, ThreadPool *pool = nullptr);
+    bool refine(SolutionClass *s) override;
 };
 
 template <typename SolutionClass>
@@ -99,7 +169,9 @@ public:
     Evaluator<SolutionClass> *evl;
     RefinementHeuristicsMethod<SolutionClass> *rh;
     LocalSearch(Evaluator<SolutionClass> *evl, RefinementHeuristicsMethod<SolutionClass> *rh);
-    virtual SolutionClass* run(const SolutionClass *s, float t) = 0;
+    virtual ~LocalSearch() = default;
+    // Charges one evaluation per refinement and reports improved values through budget->improved().
+    virtual SolutionClass* run(const SolutionClass *s, Budget *budget) = 0;
 };
 
 template <typename SolutionClass>
@@ -107,7 +179,7 @@ class LSHillClimbing : public LocalSearch<SolutionClass> {
     static_assert(std::is_base_of<Solution, SolutionClass>::value, "SolutionClass must be a descendant of Solution");
 public:
     LSHillClimbing(Evaluator<SolutionClass> *evl, RefinementHeuristicsMethod<SolutionClass> *rh);
-    SolutionClass* run(const SolutionClass *s, float t) override;
+    SolutionClass* run(const SolutionClass *s, Budget *budget) override;
 };
 
 template <typename SolutionClass>
@@ -117,7 +189,7 @@ private:
     int k;
 public:
     RandomDescentMethod(Evaluator<SolutionClass> *evl, RefinementHeuristicsMethod<SolutionClass> *rh, int k);
-    SolutionClass* run(const SolutionClass *s, float t) override;
+    SolutionClass* run(const SolutionClass *s, Budget *budget) override;
 };
 
 #include "neighborhood_exploration.tpp"
@@ -1,170 +1,313 @@
 #include "neighborhood_exploration.h"
 
-template <class SolutionClass>
-NeighborhoodExplorationMethod<SolutionClass>::NeighborhoodExplorationMethod(Evaluator<SolutionClass> *evl, MovementGenerator<SolutionClass> *mg) {
+template <class SolutionClass, class MovementClass, class GeneratorClass>
+NeighborhoodExplorationMethod<SolutionClass, MovementClass, GeneratorClass>::NeighborhoodExplorationMethod(Evaluator<SolutionClass> *evl, GeneratorClass *mg) {
     this->evl = evl;
     this->mg = mg;
 }
 
-template <class SolutionClass>
-NEFindAny<SolutionClass>::NEFindAny(Evaluator<SolutionClass> *evl, MovementGenerator<SolutionClass> *mg, int k)
-    : NeighborhoodExplorationMethod<SolutionClass>(evl, mg), k(k) {}
+template <class SolutionClass, class MovementClass, class GeneratorClass>
+NEFindAny<SolutionClass, MovementClass, GeneratorClass>::NEFindAny(Evaluator<SolutionClass> *evl, GeneratorClass *mg, int k, Random *rng)
+    : NeighborhoodExplorationMethod<SolutionClass, MovementClass, GeneratorClass>(evl, mg), k(k), rng(Random::or_default(rng)) {}
+
+template <class SolutionClass, class MovementClass, class GeneratorClass>
+bool NEFindAny<SolutionClass, MovementClass, GeneratorClass>::get_movement(const SolutionClass *s, MovementClass *m) {
+    bool found = false;
 
-template <class SolutionClass>
-Movement<SolutionClass>* NEFindAny<SolutionClass>::get_movement(const SolutionClass *s) {
-    Movement<SolutionClass>* curr_m = NULL;
-    
     for (int i = 0; i < this->k; i++) {
-        Movement<SolutionClass> *m = this->mg->get_random();
+        MovementClass m1 = this->mg->get_random(this->rng);
 
-        if (m->delta(s) > 0) {
-            delete curr_m;
-            curr_m = m;
-        } else {
-            delete m;
+        if (m1.delta(s) > 0) {
+            *m = m1;
+            found = true;
         }
     }
 
-    return curr_m;
+    return found;
 }
 
-template <class SolutionClass>
-NEFindFirst<SolutionClass>::NEFindFirst(Evaluator<SolutionClass> *evl, MovementGenerator<SolutionClass> *mg)
-    : NeighborhoodExplorationMethod<SolutionClass>(evl, mg) {}
+template <class SolutionClass, class MovementClass, class GeneratorClass>
+NEFindFirst<SolutionClass, MovementClass, GeneratorClass>::NEFindFirst(Evaluator<SolutionClass> *evl, GeneratorClass *mg)
+    : NeighborhoodExplorationMethod<SolutionClass, MovementClass, GeneratorClass>(evl, mg) {}
 
-template <class SolutionClass>
-Movement<SolutionClass>* NEFindFirst<SolutionClass>::get_movement(const SolutionClass *s) {
-    long long value = this->evl->get_evaluation(s);
-
-    this->mg->reset();
-    while (this->mg->has_next()) {
-        Movement<SolutionClass> *m = this->mg->next();
-        if (m->delta(s) > 0) return m;
-        delete m;
+template <class SolutionClass, class MovementClass, class GeneratorClass>
+bool NEFindFirst<SolutionClass, MovementClass, GeneratorClass>::get_movement(const SolutionClass *s, MovementClass *m) {
+    for (const MovementClass &m1 : NeighborhoodRange<SolutionClass, MovementClass, GeneratorClass>(this->mg)) {
+        if (m1.delta(s) > 0) {
+            *m = m1;
+            return true;
+        }
     }
 
-    return NULL;
+    return false;
 }
 
-template <class SolutionClass>
-NEFindNext<SolutionClass>::NEFindNext(Evaluator<SolutionClass> *evl, MovementGenerator<SolutionClass> *mg, int j)
-    : NeighborhoodExplorationMethod<SolutionClass>(evl, mg), j(j) {}
-
-template <class SolutionClass>
-Movement<SolutionClass>* NEFindNext<SolutionClass>::get_movement(const SolutionClass *s) {
-    this->mg->reset();
-    for (int i = 0; i <= this->j; i++)
-        delete this->mg->next();
-
-    long long value = this->evl->get_evaluation(s);
-    while (this->mg->has_next()) {
-        Movement<SolutionClass> *m = this->mg->next();
-        
-        if (m->delta(s) > 0) return m;
-        delete m;
+template <class SolutionClass, class MovementClass, class GeneratorClass>
+NEFindNext<SolutionClass, MovementClass, GeneratorClass>::NEFindNext(Evaluator<SolutionClass> *evl, GeneratorClass *mg, int j)
+    : NeighborhoodExplorationMethod<SolutionClass, MovementClass, GeneratorClass>(evl, mg), j(j) {}
+
+template <class SolutionClass, class MovementClass, class GeneratorClass>
+bool NEFindNext<SolutionClass, MovementClass, GeneratorClass>::get_movement(const SolutionClass *s, MovementClass *m) {
+    NeighborhoodRange<SolutionClass, MovementClass, GeneratorClass> range(this->mg, this->j + 1, this->mg->size());
+    for (const MovementClass &m1 : range) {
+        if (m1.delta(s) > 0) {
+            *m = m1;
+            return true;
+        }
     }
 
-    return NULL;
+    return false;
 }
 
-template <class SolutionClass>
-NEFindBest<SolutionClass>::NEFindBest(Evaluator<SolutionClass> *evl, MovementGenerator<SolutionClass> *mg)
-    : NeighborhoodExplorationMethod<SolutionClass>(evl, mg) {}
+template <class SolutionClass, class MovementClass, class GeneratorClass>
+NEFindBest<SolutionClass, MovementClass, GeneratorClass>::NEFindBest(Evaluator<SolutionClass> *evl, GeneratorClass *mg)
+    : NeighborhoodExplorationMethod<SolutionClass, MovementClass, GeneratorClass>(evl, mg) {}
 
-template <class SolutionClass>
-Movement<SolutionClass>* NEFindBest<SolutionClass>::get_movement(const SolutionClass *s) {
-    this->mg->reset();
-
-    Movement<SolutionClass>* curr_m = NULL;
+template <class SolutionClass, class MovementClass, class GeneratorClass>
+bool NEFindBest<SolutionClass, MovementClass, GeneratorClass>::get_movement(const SolutionClass *s, MovementClass *m) {
+    bool found = false;
     long long delta_prime = 0;
-    while (this->mg->has_next()) {
-        Movement<SolutionClass> *m = this->mg->next();
-
-        long long delta = m->delta(s);
+    for (const MovementClass &m1 : NeighborhoodRange<SolutionClass, MovementClass, GeneratorClass>(this->mg)) {
+        long long delta = m1.delta(s);
         if (delta > delta_prime) {
-            delete curr_m;
-            curr_m = m;
+            *m = m1;
+            found = true;
             delta_prime = delta;
-        } else {
-            delete m;
         }
     }
 
-    return curr_m;
+    return found;
 }
 
-template <class SolutionClass>
-std::vector<SolutionClass*> all_neighbors(SolutionClass *s, MovementGenerator<SolutionClass> *mg) {
+template <class SolutionClass, class MovementClass, class GeneratorClass>
+NEParallelFindBest<SolutionClass, MovementClass, GeneratorClass>::NEParallelFindBest(Evaluator<SolutionClass> *evl, GeneratorClass *mg, ThreadPool *pool, size_t chunks_per_thread)
+    : NeighborhoodExplorationMethod<SolutionClass, MovementClass, GeneratorClass>(evl, mg), pool(pool), chunks_per_thread(chunks_per_thread) {}
+
+template <class SolutionClass, class MovementClass, class GeneratorClass>
+bool NEParallelFindBest<SolutionClass, MovementClass, GeneratorClass>::get_movement(const SolutionClass *s, MovementClass *m) {
+    NeighborhoodRange<SolutionClass, MovementClass, GeneratorClass> range(this->mg);
+    if (range.size() == 0) return false;
+
+    // delta() may fill lazily computed caches of s (evaluation, prefix sums);
+    // compute one here so the workers only ever read s.
+    this->mg->at(0).delta(s);
+
+    struct alignas(64) ChunkBest {
+        bool found = false;
+        long long delta = 0;
+        MovementClass m;
+    };
+
+    size_t chunks = std::max((size_t) 1, this->pool->size() * this->chunks_per_thread);
+    std::vector<ChunkBest> best(chunks);
+
+    this->pool->parallel_for(chunks, [&](size_t c) {
+        ChunkBest local;
+        for (const MovementClass &m1 : range.chunk(c, chunks)) {
+            long long delta = m1.delta(s);
+            if (delta > local.delta) {
+                local.found = true;
+                local.delta = delta;
+                local.m = m1;
+            }
+        }
+        best[c] = local;
+    });
+
+    bool found = false;
+    long long delta_prime = 0;
+    for (const ChunkBest &b : best) {
+        if (b.found && b.delta > delta_prime) {
+            *m = b.m;
+            found = true;
+            delta_prime = b.delta;
+        }
+    }
+
+    return found;
+}
+
+template <class SolutionClass, class MovementClass, class GeneratorClass>
+NEParallelFindFirst<SolutionClass, MovementClass, GeneratorClass>::NEParallelFindFirst(
+    Evaluator<SolutionClass> *evl,
+    GeneratorClass *mg,
+    ThreadPool *pool,
+    FirstImprovementOrder order,
+    size_t chunks_per_thread
+)
+    : NeighborhoodExplorationMethod<SolutionClass, MovementClass, GeneratorClass>(evl, mg), pool(pool), order(order), chunks_per_thread(chunks_per_thread) {}
+
+template <class SolutionClass, class MovementClass, class GeneratorClass>
+bool NEParallelFindFirst<SolutionClass, MovementClass, GeneratorClass>::get_movement(const SolutionClass *s, MovementClass *m) {
+    NeighborhoodRange<SolutionClass, MovementClass, GeneratorClass> range(this->mg);
+    if (range.size() == 0) return false;
+
+    this->mg->at(0).delta(s);  // fills the lazy caches of s before the workers read it, as in NEParallelFindBest
+
+    const size_t NONE = std::numeric_limits<size_t>::max();
+    std::atomic<size_t> found_index(NONE);  // lowest index found so far (LOWEST_INDEX) or the winner's (FIRST_FOUND)
+    MovementClass found_m;
+
+    size_t chunks = std::max((size_t) 1, this->pool->size() * this->chunks_per_thread);
+    std::vector<MovementClass> chunk_m(chunks);
+
+    // parallel_for hands chunks out in increasing order, so with LOWEST_INDEX a chunk starting
+    // past an improvement already found can be skipped and a running one stops once it passes it.
+    this->pool->parallel_for(chunks, [&](size_t c) {
+        NeighborhoodRange<SolutionClass, MovementClass, GeneratorClass> chunk = range.chunk(c, chunks);
+        for (auto it = chunk.begin(); it != chunk.end(); ++it) {
+            size_t limit = found_index.load(std::memory_order_relaxed);
+            if (this->order == FirstImprovementOrder::FIRST_FOUND ? limit != NONE : it.index() > limit)
+                return;
+
+            if (it->delta(s) <= 0) continue;
+
+            if (this->order == FirstImprovementOrder::FIRST_FOUND) {
+                size_t expected = NONE;
+                if (found_index.compare_exchange_strong(expected, it.index()))
+                    found_m = *it;
+            } else {
+                chunk_m[c] = *it;
+                size_t curr = found_index.load();
+                while (it.index() < curr && !found_index.compare_exchange_weak(curr, it.index()));
+            }
+            return;
+        }
+    });
+
+    size_t k = found_index.load();
+    if (k == NONE) return false;
+
+    if (this->order == FirstImprovementOrder::FIRST_FOUND) {
+        *m = found_m;
+    } else {
+        // each chunk holds at most one candidate, the lowest index one is the winner
+        for (size_t c = 0; c < chunks; c++) {
+            NeighborhoodRange<SolutionClass, MovementClass, GeneratorClass> chunk = range.chunk(c, chunks);
+            if (chunk.size() > 0 && chunk.end().index() > k) {
+                *m = chunk_m[c];
+                break;
+            }
+        }
+    }
+
+    return true;
+}
+
+template <class SolutionClass, class MovementClass, class GeneratorClass>
+std::vector<SolutionClass*> all_neighbors(SolutionClass *s, GeneratorClass *mg) {
     static_assert(std::is_base_of<Solution, SolutionClass>::value, "SolutionClass must be a descendant of Solution");
 
     std::vector<SolutionClass*> r;
-    for (Movement<SolutionClass> *m : mg->get_all(s)) {
+    for (const MovementClass &m : NeighborhoodRange<SolutionClass, MovementClass, GeneratorClass>(mg)) {
         SolutionClass *s1 = (SolutionClass*) s->clone();
-        m->move(s1);
+        m.move(s1);
         r.push_back(s1);
-        delete m;
     }
 
     return r;
 }
 
 template <class SolutionClass>
-RefinementHeuristicsMethod<SolutionClass>::RefinementHeuristicsMethod(Evaluator<SolutionClass> *evl, MovementGenerator<SolutionClass> *mg) {
+RefinementHeuristicsMethod<SolutionClass>::RefinementHeuristicsMethod(Evaluator<SolutionClass> *evl) {
     this->evl = evl;
-    this->mg = mg;
 }
 
 template <class SolutionClass>
-RHRandomSelection<SolutionClass>::RHRandomSelection(Evaluator<SolutionClass> *evl, MovementGenerator<SolutionClass> *mg, int k)
-    : RefinementHeuristicsMethod<SolutionClass>(evl, mg), k(k) {}
+SolutionClass* RefinementHeuristicsMethod<SolutionClass>::run(const SolutionClass *s) {
+    SolutionClass *s1 = (SolutionClass*) s->clone();
+    if (this->refine(s1)) return s1;
 
-template <class SolutionClass>
-SolutionClass* RHRandomSelection<SolutionClass>::run(const SolutionClass *s) {
-    NEFindAny<SolutionClass> ne(this->evl, this->mg, this->k);
-    Movement<SolutionClass>* m = ne.get_movement(s);
+    delete s1;
+    return NULL;
+}
 
-    if (m == NULL) return NULL;
+template <class SolutionClass, class MovementClass, class GeneratorClass>
+RHRandomSelection<SolutionClass, MovementClass, GeneratorClass>::RHRandomSelection(Evaluator<SolutionClass> *evl, GeneratorClass *mg, int k, Random *rng)
+    : RefinementHeuristicsMethod<SolutionClass>(evl), k(k), rng(Random::or_default(rng)), mg(mg) {}
 
-    SolutionClass *s1 = (SolutionClass*) s->clone();
-    m->move(s1);
-    delete m;
+template <class SolutionClass, class MovementClass, class GeneratorClass>
+bool RHRandomSelection<SolutionClass, MovementClass, GeneratorClass>::refine(SolutionClass *s) {
+    NEFindAny<SolutionClass, MovementClass, GeneratorClass> ne(this->evl, this->mg, this->k, this->rng);
+    MovementClass m;
+    if (!ne.get_movement(s, &m)) return false;
+
+    m.move(s);
+    Telemetry::count(TelemetryCounter::MOVES);
 
-    return s1;
+    return true;
 }
 
-template <class SolutionClass>
-RHFirstImprovement<SolutionClass>::RHFirstImprovement(Evaluator<SolutionClass> *evl, MovementGenerator<SolutionClass> *mg)
-    : RefinementHeuristicsMethod<SolutionClass>(evl, mg) {}
+template <class SolutionClass, class MovementClass, class GeneratorClass>
+RHFirstImprovement<SolutionClass, MovementClass, GeneratorClass>::RHFirstImprovement(
+    Evaluator<SolutionClass> *evl,
+    GeneratorClass *mg,
+    ThreadPool *pool,
+    FirstImprovementOrder order
+)
+    : RefinementHeuristicsMethod<SolutionClass>(evl), mg(mg), pool(pool), order(order) {}
+
+template <class SolutionClass, class MovementClass, class GeneratorClass>
+bool RHFirstImprovement<SolutionClass, MovementClass, GeneratorClass>::refine(SolutionClass *s) {
+    MovementClass m;
+    if (this->pool != nullptr) {
+        NEParallelFindFirst<SolutionClass, MovementClass, GeneratorClass> ne(this->evl, this->mg, this->pool, this->order);
+        if (!ne.get_movement(s, &m)) return false;
+    } else {
+        NEFindFirst<SolutionClass, MovementClass, GeneratorClass> ne(this->evl, this->mg);
+        if (!ne.get_movement(s, &m)) return false;
+    }
 
-template <class SolutionClass>
-SolutionClass* RHFirstImprovement<SolutionClass>::run(const SolutionClass *s) {
-    NEFindFirst<SolutionClass> ne(this->evl, this->mg);
-    Movement<SolutionClass>* m = ne.get_movement(s);
+    m.move(s);
+    Telemetry::count(TelemetryCounter::MOVES);
 
-    if (m == NULL) return NULL;
-    
-    SolutionClass *s1 = (SolutionClass*) s->clone();
-    m->move(s1);
-    delete m;
+    return true;
+}
 
-    return s1;
+template <class SolutionClass, class MovementClass, class GeneratorClass>
+RHNextImprovement<SolutionClass, MovementClass, GeneratorClass>::RHNextImprovement(Evaluator<SolutionClass> *evl, GeneratorClass *mg)
+    : RefinementHeuristicsMethod<SolutionClass>(evl), position(0), mg(mg) {}
+
+template <class SolutionClass, class MovementClass, class GeneratorClass>
+bool RHNextImprovement<SolutionClass, MovementClass, GeneratorClass>::refine(SolutionClass *s) {
+    size_t size = this->mg->size();
+    if (this->position >= size) this->position = 0;
+
+    // from the position to the end, then wrapping around to it
+    NeighborhoodRange<SolutionClass, MovementClass, GeneratorClass> tail(this->mg, this->position, size), head(this->mg, 0, this->position);
+    for (const NeighborhoodRange<SolutionClass, MovementClass, GeneratorClass> &range : { tail, head }) {
+        for (auto it = range.begin(); it != range.end(); ++it) {
+            if (it->delta(s) > 0) {
+                it->move(s);
+                Telemetry::count(TelemetryCounter::MOVES);
+                this->position = it.index() + 1;
+                return true;
+            }
+        }
+    }
+
+    return false;
 }
 
-template <class SolutionClass>
-RHBestImprovement<SolutionClass>::RHBestImprovement(Evaluator<SolutionClass> *evl, MovementGenerator<SolutionClass> *mg)
-    : RefinementHeuristicsMethod<SolutionClass>(evl, mg) {}
+template <class SolutionClass, class MovementClass, class GeneratorClass>
+RHBestImprovement<SolutionClass, MovementClass, GeneratorClass>::RHBestImprovement(Evaluator<SolutionClass> *evl, GeneratorClass *mg, ThreadPool *pool)
+    : RefinementHeuristicsMethod<SolutionClass>(evl), mg(mg), pool(pool) {}
+
+template <class SolutionClass, class MovementClass, class GeneratorClass>
+bool RHBestImprovement<SolutionClass, MovementClass, GeneratorClass>::refine(SolutionClass *s) {
+    MovementClass m;
+    if (this->pool != nullptr) {
+        NEParallelFindBest<SolutionClass, MovementClass, GeneratorClass> ne(this->evl, this->mg, this->pool);
+        if (!ne.get_movement(s, &m)) return false;
+    } else {
+        NEFindBest<SolutionClass, MovementClass, GeneratorClass> ne(this->evl, this->mg);
+        if (!ne.get_movement(s, &m)) return false;
+    }
 
-template <class SolutionClass>
-SolutionClass* RHBestImprovement<SolutionClass>::run(const SolutionClass *s) {
-    NEFindBest<SolutionClass> ne(this->evl, this->mg);
-    Movement<SolutionClass>* m = ne.get_movement(s);
+    m.move(s);
+    Telemetry::count(TelemetryCounter::MOVES);
 
-    if (m == NULL) return NULL;
-    
-    SolutionClass *s1 = (SolutionClass*) s->clone();
-    m->move(s1);
-    delete m;
-    return s1;
+    return true;
 }
 
 template <class SolutionClass>
@@ -178,21 +321,13 @@ LSHillClimbing<SolutionClass>::LSHillClimbing(Evaluator<SolutionClass> *evl, Ref
     : LocalSearch<SolutionClass>(evl, rh) {}
 
 template <class SolutionClass>
-SolutionClass* LSHillClimbing<SolutionClass>::run(const SolutionClass *s, float t) {
-    auto start = std::chrono::high_resolution_clock::now();
-
+SolutionClass* LSHillClimbing<SolutionClass>::run(const SolutionClass *s, Budget *budget) {
     SolutionClass *curr = (SolutionClass*) s->clone();
 
-    while (true) {
-        auto current = std::chrono::high_resolution_clock::now();
-        if (std::chrono::duration<float>(current - start).count() > t)
-            break;
-
-        SolutionClass *s1 = this->rh->run(curr);
-        if (s1 == NULL) break;
-
-        delete curr;
-        curr = s1;        
+    while (!budget->expired()) {
+        budget->charge();
+        if (!this->rh->refine(curr)) break;
+        budget->improved(this->evl->get_evaluation(curr));
     }
 
     return curr;
@@ -203,23 +338,20 @@ RandomDescentMethod<SolutionClass>::RandomDescentMethod(Evaluator<SolutionClass>
     : LocalSearch<SolutionClass>(evl, rh), k(k) {}
 
 template <class SolutionClass>
-SolutionClass* RandomDescentMethod<SolutionClass>::run(const SolutionClass *s, float t) {
-    auto start = std::chrono::high_resolution_clock::now();
-
+SolutionClass* RandomDescentMethod<SolutionClass>::run(const SolutionClass *s, Budget *budget) {
     SolutionClass *curr = (SolutionClass*) s->clone();
     int curr_k = this->k;
     while (curr_k > 0) {
-        auto current = std::chrono::high_resolution_clock::now();
-        if (std::chrono::duration<float>(current - start).count() > t)
+        if (budget->expired())
             break;
 
-        SolutionClass *s1 = this->rh->run(curr);
-        if (s1 == NULL) break;
+        budget->charge();
+        long long value = this->evl->get_evaluation(curr);
+        if (!this->rh->refine(curr)) break;
 
-        if (this->evl->get_evaluation(s1) > this->evl->get_evaluation(curr)) {
-            delete curr;
-            curr = s1;
-            curr_k = k;            
+        if (this->evl->get_evaluation(curr) > value) {
+            budget->improved(this->evl->get_evaluation(curr));
+            curr_k = k;
         } else {
             curr_k--;
         }
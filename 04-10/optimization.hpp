@@ -2,7 +2,9 @@
 #define OPTIMIZATION_H
 
 #include <vector>
+#include <algorithm>
 #include <type_traits>
+#include "random.h"
 
 template <class SolutionClass>
 class Evaluator;
@@ -19,11 +21,11 @@ protected:
     void set_evaluation(long long e) const;
 public:
     Solution();
+    virtual ~Solution() = default;
     virtual Solution* clone() const = 0;
+    virtual void copy_from(const Solution *s) = 0;
     template <class SolutionClass>
     friend class Evaluator;
-    template <class SolutionClass>
-    friend class Movement;
 };
 
 template <class SolutionClass>
@@ -35,23 +37,69 @@ public:
     virtual long long get_evaluation(const SolutionClass *s) const;
 };
 
-template <class SolutionClass>
-class Movement {
-    static_assert(std::is_base_of<Solution, SolutionClass>::value, "SolutionClass must be a descendant of Solution");
+template <class SolutionClass, class MovementClass>
+class MovementGenerator;
+
+// Lazy view over the movements [first, last) of a generator's enumeration order.
+// Iterating it builds one movement at a time, so memory stays O(1) whatever the neighborhood size,
+// and disjoint chunks of the same range can be handed to different consumers.
+// Ranges over a concrete (final) generator class can inline its at() and advance() calls.
+template <class SolutionClass, class MovementClass, class GeneratorClass = MovementGenerator<SolutionClass, MovementClass>>
+class NeighborhoodRange {
+private:
+    const GeneratorClass *mg;
+    size_t first, last;
 public:
-    virtual void move(SolutionClass *s) = 0;
-    virtual long long delta(const SolutionClass *s) const = 0;
+    class iterator {
+    private:
+        const GeneratorClass *mg;
+        size_t k;
+        MovementClass m;
+    public:
+        iterator(const GeneratorClass *mg, size_t k);
+        iterator(const GeneratorClass *mg, size_t k, MovementClass m);
+        const MovementClass& operator*() const;
+        const MovementClass* operator->() const;
+        iterator& operator++();
+        bool operator==(const iterator &it) const;
+        bool operator!=(const iterator &it) const;
+        size_t index() const;
+    };
+    NeighborhoodRange(const GeneratorClass *mg);  // the whole neighborhood
+    NeighborhoodRange(const GeneratorClass *mg, size_t first, size_t last);
+    iterator begin() const;
+    iterator end() const;
+    size_t size() const;
+    NeighborhoodRange chunk(size_t c, size_t chunks) const;  // c-th of 'chunks' contiguous slices
 };
 
-template <class SolutionClass>
+// Movements are small trivially copyable values providing
+//     void move(SolutionClass *s) const;
+//     void undo(SolutionClass *s) const;
+//     long long delta(const SolutionClass *s) const;
+// Generators hand them out by value and the exploration methods are templated on them,
+// so no movement is ever heap-allocated and move/delta calls can be inlined.
+template <class SolutionClass, class MovementClass>
 class MovementGenerator {
     static_assert(std::is_base_of<Solution, SolutionClass>::value, "SolutionClass must be a descendant of Solution");
+    static_assert(std::is_trivially_copyable<MovementClass>::value, "MovementClass must be trivially copyable");
+private:
+    size_t cursor;  // index of the movement next() returns
+    MovementClass cursor_m;
+    bool cursor_m_valid;  // cursor_m is computed on the first next() after a seek
 public:
-    virtual std::vector<Movement<SolutionClass>*> get_all(const SolutionClass *s) = 0;
-    virtual Movement<SolutionClass>* get_random() = 0;
-    virtual bool has_next() = 0;
-    virtual Movement<SolutionClass>* next() = 0;
-    virtual void reset() = 0; 
+    MovementGenerator();
+    virtual ~MovementGenerator() = default;
+    virtual size_t size() const = 0;  // number of movements in the neighborhood
+    virtual MovementClass at(size_t k) const = 0;  // k-th movement of the enumeration order
+    virtual void advance(MovementClass *m) const = 0;  // replaces m by the movement enumerated after it
+    NeighborhoodRange<SolutionClass, MovementClass> neighborhood() const;
+    virtual MovementClass get_random(Random *rng) const = 0;
+    bool has_next() const;
+    MovementClass next();
+    void reset();
+    void seek(size_t k);  // O(1) jump of the cursor to the k-th movement
+    size_t tell() const;  // cursor position, can be restored later with seek()
 };
 
 #include "optimization.tpp"
@@ -7,3 +7,124 @@ long long Evaluator<SolutionClass>::get_evaluation(const SolutionClass *s) const
 
     return s->get_last_evaluation();
 };
+
+
+template <class SolutionClass, class MovementClass, class GeneratorClass>
+NeighborhoodRange<SolutionClass, MovementClass, GeneratorClass>::iterator::iterator(const GeneratorClass *mg, size_t k)
+    : mg(mg), k(k), m() {}
+
+template <class SolutionClass, class MovementClass, class GeneratorClass>
+NeighborhoodRange<SolutionClass, MovementClass, GeneratorClass>::iterator::iterator(const GeneratorClass *mg, size_t k, MovementClass m)
+    : mg(mg), k(k), m(m) {}
+
+template <class SolutionClass, class MovementClass, class GeneratorClass>
+const MovementClass& NeighborhoodRange<SolutionClass, MovementClass, GeneratorClass>::iterator::operator*() const {
+    return this->m;
+}
+
+template <class SolutionClass, class MovementClass, class GeneratorClass>
+const MovementClass* NeighborhoodRange<SolutionClass, MovementClass, GeneratorClass>::iterator::operator->() const {
+    return &this->m;
+}
+
+template <class SolutionClass, class MovementClass, class GeneratorClass>
+typename NeighborhoodRange<SolutionClass, MovementClass, GeneratorClass>::iterator& NeighborhoodRange<SolutionClass, MovementClass, GeneratorClass>::iterator::operator++() {
+    this->k++;
+    this->mg->advance(&this->m);
+    return *this;
+}
+
+template <class SolutionClass, class MovementClass, class GeneratorClass>
+bool NeighborhoodRange<SolutionClass, MovementClass, GeneratorClass>::iterator::operator==(const iterator &it) const {
+    return this->k == it.k;
+}
+
+template <class SolutionClass, class MovementClass, class GeneratorClass>
+bool NeighborhoodRange<SolutionClass, MovementClass, GeneratorClass>::iterator::operator!=(const iterator &it) const {
+    return this->k != it.k;
+}
+
+template <class SolutionClass, class MovementClass, class GeneratorClass>
+size_t NeighborhoodRange<SolutionClass, MovementClass, GeneratorClass>::iterator::index() const {
+    return this->k;
+}
+
+template <class SolutionClass, class MovementClass, class GeneratorClass>
+NeighborhoodRange<SolutionClass, MovementClass, GeneratorClass>::NeighborhoodRange(const GeneratorClass *mg)
+    : NeighborhoodRange(mg, 0, mg->size()) {}
+
+template <class SolutionClass, class MovementClass, class GeneratorClass>
+NeighborhoodRange<SolutionClass, MovementClass, GeneratorClass>::NeighborhoodRange(const GeneratorClass *mg, size_t first, size_t last) {
+    this->mg = mg;
+    this->first = first;
+    this->last = last;
+}
+
+template <class SolutionClass, class MovementClass, class GeneratorClass>
+typename NeighborhoodRange<SolutionClass, MovementClass, GeneratorClass>::iterator NeighborhoodRange<SolutionClass, MovementClass, GeneratorClass>::begin() const {
+    if (this->first >= this->last) return this->end();
+    return iterator(this->mg, this->first, this->mg->at(this->first));
+}
+
+template <class SolutionClass, class MovementClass, class GeneratorClass>
+typename NeighborhoodRange<SolutionClass, MovementClass, GeneratorClass>::iterator NeighborhoodRange<SolutionClass, MovementClass, GeneratorClass>::end() const {
+    return iterator(this->mg, this->last);
+}
+
+template <class SolutionClass, class MovementClass, class GeneratorClass>
+size_t NeighborhoodRange<SolutionClass, MovementClass, GeneratorClass>::size() const {
+    return this->last - this->first;
+}
+
+template <class SolutionClass, class MovementClass, class GeneratorClass>
+NeighborhoodRange<SolutionClass, MovementClass, GeneratorClass> NeighborhoodRange<SolutionClass, MovementClass, GeneratorClass>::chunk(size_t c, size_t chunks) const {
+    size_t n = this->size();
+    size_t chunk_first = this->first + n / chunks * c + std::min(c, n % chunks);
+    size_t chunk_size = n / chunks + (c < n % chunks ? 1 : 0);
+    return NeighborhoodRange(this->mg, chunk_first, chunk_first + chunk_size);
+}
+
+template <class SolutionClass, class MovementClass>
+NeighborhoodRange<SolutionClass, MovementClass> MovementGenerator<SolutionClass, MovementClass>::neighborhood() const {
+    return NeighborhoodRange<SolutionClass, MovementClass>(this, 0, this->size());
+}
+
+template <class SolutionClass, class MovementClass>
+MovementGenerator<SolutionClass, MovementClass>::MovementGenerator() {
+    this->cursor = 0;
+    this->cursor_m_valid = false;
+}
+
+template <class SolutionClass, class MovementClass>
+bool MovementGenerator<SolutionClass, MovementClass>::has_next() const {
+    return this->cursor < this->size();
+}
+
+template <class SolutionClass, class MovementClass>
+MovementClass MovementGenerator<SolutionClass, MovementClass>::next() {
+    if (!this->cursor_m_valid) {
+        this->cursor_m = this->at(this->cursor);
+        this->cursor_m_valid = true;
+    }
+
+    MovementClass m = this->cursor_m;
+    this->cursor++;
+    this->advance(&this->cursor_m);
+    return m;
+}
+
+template <class SolutionClass, class MovementClass>
+void MovementGenerator<SolutionClass, MovementClass>::reset() {
+    this->seek(0);
+}
+
+template <class SolutionClass, class MovementClass>
+void MovementGenerator<SolutionClass, MovementClass>::seek(size_t k) {
+    this->cursor = k;
+    this->cursor_m_valid = false;
+}
+
+template <class SolutionClass, class MovementClass>
+size_t MovementGenerator<SolutionClass, MovementClass>::tell() const {
+    return this->cursor;
+}
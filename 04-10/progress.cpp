@@ -0,0 +1,38 @@
+#include "progress.h"
+#include <limits>
+
+ProgressRecorder::ProgressRecorder()
+    : best(std::numeric_limits<long long>::min()) {}
+
+void ProgressRecorder::record(double time, long long evaluations, long long value) {
+    if (value <= this->best.load(std::memory_order_relaxed)) return;
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+    if (value <= this->best.load(std::memory_order_relaxed)) return;
+
+    // concurrent reporters may read the clock out of order
+    if (!this->events.empty() && time < this->events.back().time)
+        time = this->events.back().time;
+    this->events.push_back({ time, evaluations, value });
+    this->best.store(value, std::memory_order_relaxed);
+}
+
+long long ProgressRecorder::get_best() const {
+    return this->best.load(std::memory_order_relaxed);
+}
+
+std::vector<ProgressEvent> ProgressRecorder::get_events() {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->events;
+}
+
+bool ProgressRecorder::first_reaching(long long target, ProgressEvent *event) {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    for (const ProgressEvent &e : this->events) {
+        if (e.value >= target) {
+            *event = e;
+            return true;
+        }
+    }
+    return false;
+}
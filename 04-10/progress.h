@@ -0,0 +1,31 @@
+#ifndef PROGRESS_H
+#define PROGRESS_H
+
+#include <vector>
+#include <mutex>
+#include <atomic>
+
+struct ProgressEvent {
+    double time;  // seconds since the start of the recorded budget
+    long long evaluations;
+    long long value;
+};
+
+// Anytime profile of a run: one event each time the best value found so far improves.
+// Searches report through Budget::improved(), from any thread.
+class ProgressRecorder {
+private:
+    std::mutex mutex;
+    std::vector<ProgressEvent> events;
+    std::atomic<long long> best;
+public:
+    ProgressRecorder();
+    ProgressRecorder(const ProgressRecorder&) = delete;
+    ProgressRecorder& operator=(const ProgressRecorder&) = delete;
+    void record(double time, long long evaluations, long long value);  // ignored unless value beats the best so far
+    long long get_best() const;
+    std::vector<ProgressEvent> get_events();  // by increasing time and value
+    bool first_reaching(long long target, ProgressEvent *event);  // false if no event reached target
+};
+
+#endif // PROGRESS_H
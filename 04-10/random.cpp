@@ -0,0 +1,48 @@
+#include "random.h"
+
+std::atomic<uint64_t> Random::next_thread_stream(0);
+
+Random::Random(uint64_t seed, uint64_t stream) {
+    this->seed(seed, stream);
+}
+
+void Random::seed(uint64_t seed, uint64_t stream) {
+    // splitmix64 spreads the seed over the whole state, which must not be all zeros
+    for (int i = 0; i < 4; i++) {
+        seed += 0x9E3779B97F4A7C15ULL;
+        uint64_t z = seed;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        this->state[i] = z ^ (z >> 31);
+    }
+
+    for (uint64_t k = 0; k < stream; k++)
+        this->jump();
+}
+
+void Random::jump() {
+    static const uint64_t JUMP[] = { 0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL, 0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL };
+
+    uint64_t s[4] = { 0, 0, 0, 0 };
+    for (uint64_t jump : JUMP) {
+        for (int b = 0; b < 64; b++) {
+            if (jump & ((uint64_t) 1 << b)) {
+                for (int i = 0; i < 4; i++)
+                    s[i] ^= this->state[i];
+            }
+            this->next();
+        }
+    }
+
+    for (int i = 0; i < 4; i++)
+        this->state[i] = s[i];
+}
+
+Random& Random::thread_default() {
+    thread_local Random rng(DEFAULT_SEED, next_thread_stream++);
+    return rng;
+}
+
+Random* Random::or_default(Random *rng) {
+    return (rng != nullptr) ? rng : &Random::thread_default();
+}
@@ -0,0 +1,28 @@
+#ifndef RANDOM_H
+#define RANDOM_H
+
+#include <cstdint>
+#include <atomic>
+
+// xoshiro256++ generator. Each instance is an independent stream, so threads should own one
+// each: Random(seed, k) gives the k-th non-overlapping stream of a seed, which makes parallel
+// runs reproducible from a single seed.
+class Random {
+private:
+    uint64_t state[4];
+    static std::atomic<uint64_t> next_thread_stream;
+public:
+    static constexpr uint64_t DEFAULT_SEED = 0x9E3779B97F4A7C15ULL;
+    Random(uint64_t seed = DEFAULT_SEED, uint64_t stream = 0);
+    void seed(uint64_t seed, uint64_t stream = 0);
+    inline uint64_t next();  // 64 random bits
+    inline uint64_t uniform_int(uint64_t n);  // uniform in [0, n), without modulo bias
+    inline double uniform_real();  // uniform in [0, 1) with 53 bits of precision
+    void jump();  // advances 2^128 steps, i.e. to the start of the next stream
+    static Random& thread_default();  // per-thread generator for callers that do not inject one
+    static Random* or_default(Random *rng);
+};
+
+#include "random.tpp"
+
+#endif // RANDOM_H
@@ -0,0 +1,35 @@
+#include "random.h"
+
+inline uint64_t Random::next() {
+    auto rotl = [](uint64_t x, int k) { return (x << k) | (x >> (64 - k)); };
+
+    uint64_t result = rotl(this->state[0] + this->state[3], 23) + this->state[0];
+    uint64_t t = this->state[1] << 17;
+
+    this->state[2] ^= this->state[0];
+    this->state[3] ^= this->state[1];
+    this->state[1] ^= this->state[2];
+    this->state[0] ^= this->state[3];
+    this->state[2] ^= t;
+    this->state[3] = rotl(this->state[3], 45);
+
+    return result;
+}
+
+inline uint64_t Random::uniform_int(uint64_t n) {
+    // Lemire's multiply-shift, rejecting the few low products that would bias the result
+    __uint128_t m = (__uint128_t) this->next() * n;
+    uint64_t low = (uint64_t) m;
+    if (low < n) {
+        uint64_t threshold = -n % n;
+        while (low < threshold) {
+            m = (__uint128_t) this->next() * n;
+            low = (uint64_t) m;
+        }
+    }
+    return m >> 64;
+}
+
+inline double Random::uniform_real() {
+    return (this->next() >> 11) * 0x1.0p-53;
+}
@@ -0,0 +1,83 @@
+#include "telemetry.h"
+#include <mutex>
+#include <vector>
+#include <algorithm>
+
+namespace {
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::atomic<long long>*> live;  // counts of the threads still running
+    long long retired[(int) TelemetryCounter::COUNT] = {};
+};
+
+Registry& registry() {
+    static Registry r;
+    return r;
+}
+
+}
+
+Telemetry::ThreadCounters::ThreadCounters() {
+    for (std::atomic<long long> &x : this->counts)
+        x.store(0, std::memory_order_relaxed);
+
+    Registry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.live.push_back(this->counts);
+}
+
+Telemetry::ThreadCounters::~ThreadCounters() {
+    Registry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (int c = 0; c < (int) TelemetryCounter::COUNT; c++)
+        r.retired[c] += this->counts[c].load(std::memory_order_relaxed);
+    r.live.erase(std::find(r.live.begin(), r.live.end(), this->counts));
+}
+
+TelemetrySnapshot Telemetry::snapshot() {
+    TelemetrySnapshot snapshot;
+    Registry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (int c = 0; c < (int) TelemetryCounter::COUNT; c++) {
+        snapshot.counts[c] = r.retired[c];
+        for (std::atomic<long long> *counts : r.live)
+            snapshot.counts[c] += counts[c].load(std::memory_order_relaxed);
+    }
+    return snapshot;
+}
+
+void Telemetry::reset() {
+    Registry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (int c = 0; c < (int) TelemetryCounter::COUNT; c++) {
+        r.retired[c] = 0;
+        for (std::atomic<long long> *counts : r.live)
+            counts[c].store(0, std::memory_order_relaxed);
+    }
+}
+
+const char* Telemetry::name(TelemetryCounter c) {
+    switch (c) {
+        case TelemetryCounter::DELTAS: return "deltas";
+        case TelemetryCounter::INFEASIBLE_DELTAS: return "infeasible deltas";
+        case TelemetryCounter::MOVES: return "moves";
+        case TelemetryCounter::ACCEPTED: return "accepted";
+        case TelemetryCounter::REJECTED: return "rejected";
+        case TelemetryCounter::CLONES: return "clones";
+        case TelemetryCounter::EVALUATIONS: return "evaluations";
+        case TelemetryCounter::TEMPERATURE_LEVELS: return "temperature levels";
+        case TelemetryCounter::CONSTRUCTIONS: return "constructions";
+        default: return "?";
+    }
+}
+
+long long TelemetrySnapshot::get(TelemetryCounter c) const {
+    return this->counts[(int) c];
+}
+
+void TelemetrySnapshot::print(std::ostream &os) const {
+    for (int c = 0; c < (int) TelemetryCounter::COUNT; c++)
+        os << (c > 0 ? ", " : "") << Telemetry::name((TelemetryCounter) c) << ": " << this->counts[c];
+    os << std::endl;
+}
@@ -0,0 +1,54 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <atomic>
+#include <ostream>
+
+// Counters are only kept in builds that define KNAPSACK_TELEMETRY (make TELEMETRY=1):
+// otherwise Telemetry::count() is empty and every snapshot reads zero.
+#ifdef KNAPSACK_TELEMETRY
+#define TELEMETRY_ENABLED 1
+#else
+#define TELEMETRY_ENABLED 0
+#endif
+
+enum class TelemetryCounter {
+    DELTAS,              // movement deltas computed
+    INFEASIBLE_DELTAS,   // deltas that returned PUNISHMENT
+    MOVES,               // movements applied by a search
+    ACCEPTED,            // Metropolis decisions that applied the movement
+    REJECTED,            // Metropolis decisions that did not
+    CLONES,
+    EVALUATIONS,         // full evaluate() calls
+    TEMPERATURE_LEVELS,
+    CONSTRUCTIONS,       // GRASP constructive method calls
+    COUNT
+};
+
+struct TelemetrySnapshot {
+    long long counts[(int) TelemetryCounter::COUNT];
+    long long get(TelemetryCounter c) const;
+    void print(std::ostream &os) const;  // "name: count" pairs on one line
+};
+
+// Search instrumentation. Each thread increments its own counters without synchronization;
+// snapshot() sums them, including those of threads that already exited.
+class Telemetry {
+private:
+    struct ThreadCounters {
+        std::atomic<long long> counts[(int) TelemetryCounter::COUNT];
+        ThreadCounters();
+        ~ThreadCounters();
+    };
+    static inline ThreadCounters& local();
+public:
+    static const bool ENABLED = TELEMETRY_ENABLED;
+    static inline void count(TelemetryCounter c, long long n = 1);
+    static TelemetrySnapshot snapshot();
+    static void reset();  // must not overlap a running search
+    static const char* name(TelemetryCounter c);
+};
+
+#include "telemetry.tpp"
+
+#endif // TELEMETRY_H
@@ -0,0 +1,17 @@
+#include "telemetry.h"
+
+inline Telemetry::ThreadCounters& Telemetry::local() {
+    thread_local ThreadCounters counters;
+    return counters;
+}
+
+inline void Telemetry::count(TelemetryCounter c, long long n) {
+#if TELEMETRY_ENABLED
+    // only the owning thread writes, so a relaxed load and store replace the atomic add
+    std::atomic<long long> &x = local().counts[(int) c];
+    x.store(x.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+#else
+    (void) c;
+    (void) n;
+#endif
+}
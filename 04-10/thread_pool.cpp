@@ -0,0 +1,92 @@
+#include "thread_pool.h"
+#include <algorithm>
+
+ThreadPool::ThreadPool(size_t threads) {
+    this->pending = 0;
+    this->stopping = false;
+
+    if (threads == 0) threads = 1;
+    for (size_t i = 0; i < threads; i++)
+        this->workers.emplace_back([this]() { this->worker_loop(); });
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->stopping = true;
+    }
+    this->task_available.notify_all();
+
+    for (std::thread &t : this->workers)
+        t.join();
+}
+
+size_t ThreadPool::size() const {
+    return this->workers.size();
+}
+
+void ThreadPool::worker_loop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            this->task_available.wait(lock, [this]() { return this->stopping || !this->tasks.empty(); });
+            if (this->tasks.empty()) return;
+
+            task = std::move(this->tasks.front());
+            this->tasks.pop_front();
+        }
+
+        task();
+
+        std::lock_guard<std::mutex> lock(this->mutex);
+        if (--this->pending == 0)
+            this->all_done.notify_all();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->tasks.push_back(std::move(task));
+        this->pending++;
+    }
+    this->task_available.notify_one();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock(this->mutex);
+    this->all_done.wait(lock, [this]() { return this->pending == 0; });
+}
+
+void ThreadPool::parallel_for(size_t tasks, const std::function<void(size_t)> &f) {
+    struct State {
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> finished{0};
+        std::mutex mutex;
+        std::condition_variable done;
+    };
+    std::shared_ptr<State> state = std::make_shared<State>();
+
+    // Helpers and the caller pull indices from the same counter. Helpers that start after
+    // every index was taken return without touching f, so it only has to outlive this call.
+    auto run = [state, tasks, &f]() {
+        size_t k;
+        while ((k = state->next.fetch_add(1)) < tasks) {
+            f(k);
+            if (state->finished.fetch_add(1) + 1 == tasks) {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->done.notify_all();
+            }
+        }
+    };
+
+    size_t helpers = std::min(this->size(), tasks) - (tasks > 0 ? 1 : 0);
+    for (size_t i = 0; i < helpers; i++)
+        this->submit(run);
+
+    run();
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->done.wait(lock, [&]() { return state->finished.load() == tasks; });
+}
@@ -0,0 +1,36 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <memory>
+
+class ThreadPool {
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable task_available;
+    std::condition_variable all_done;
+    size_t pending;  // submitted tasks not finished yet
+    bool stopping;
+    void worker_loop();
+public:
+    ThreadPool(size_t threads = std::thread::hardware_concurrency());
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    ~ThreadPool();
+    size_t size() const;
+    void submit(std::function<void()> task);
+    void wait();  // blocks until every submitted task has finished
+    // Runs f(0), ..., f(tasks - 1) on the pool and blocks until all of them returned.
+    // The calling thread takes part in the work, so it is safe to call from inside a pool task.
+    void parallel_for(size_t tasks, const std::function<void(size_t)> &f);
+};
+
+#endif // THREAD_POOL_H
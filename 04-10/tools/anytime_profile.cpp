@@ -0,0 +1,232 @@
+// Anytime profiles of the searches against the known optima of the bundled instances.
+// Each run records (time, evaluations, best value) whenever its best value improves. The output directory gets:
+//   events.csv        every recorded event, with its gap to the optimum
+//   ttt.csv           per run and target gap, when the run first reached it
+//   ttt_cdf.csv       per family, algorithm and target, the empirical distribution of those times
+//   anytime.csv       per family and algorithm, the mean and worst gap at log-spaced times
+// A family is an instance directory, tests/instances-<family>, whose optima are in tests/optimum-<family>.
+// Build from 04-10/: make anytime_profile
+// Usage: anytime_profile <output_dir> [--families low_dimensional,large_scale] [--algorithms grasp,sa,hc,rdm]
+//     [--seeds N] [--time SECONDS] [--targets 0.05,0.01,0.001,0]
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <map>
+#include <cmath>
+#include <algorithm>
+#include "knapsack.h"
+#include "configurations.h"
+#include "progress.h"
+
+#define CHECKPOINTS_PER_DECADE 10
+#define FIRST_CHECKPOINT 0.0001  // seconds
+
+struct Options {
+    std::filesystem::path output_dir;
+    std::vector<std::string> families = { "low_dimensional", "large_scale" };
+    std::vector<std::string> algorithms = { "grasp", "sa", "hc", "rdm" };
+    std::vector<double> targets = { 0.05, 0.01, 0.001, 0 };
+    int seeds = 10;
+    double time = 10;
+};
+
+struct Run {
+    std::string family, instance, algorithm;
+    uint64_t seed;
+    long long optimum;
+    std::vector<ProgressEvent> events;
+};
+
+double gap(long long value, long long optimum) {
+    if (value == KnapsackEvaluator::PUNISHMENT) return 1;
+    return std::max(0.0, (optimum - value) / (double) optimum);
+}
+
+std::vector<std::string> split(const std::string &list) {
+    std::vector<std::string> items;
+    std::stringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ','))
+        items.push_back(item);
+    return items;
+}
+
+bool parse_options(int argc, char **argv, Options *options) {
+    if (argc < 2 || argc % 2 != 0) return false;
+    options->output_dir = argv[1];
+
+    for (int i = 2; i < argc; i += 2) {
+        std::string arg = argv[i], value = argv[i + 1];
+        if (arg == "--families") options->families = split(value);
+        else if (arg == "--algorithms") {
+            options->algorithms = split(value);
+            for (const std::string &algorithm : options->algorithms) {
+                if (!is_algorithm(algorithm)) {
+                    std::cerr << "Unknown algorithm '" << algorithm << "'" << std::endl;
+                    return false;
+                }
+            }
+        } else if (arg == "--seeds") options->seeds = std::stoi(value);
+        else if (arg == "--time") options->time = std::stod(value);
+        else if (arg == "--targets") {
+            options->targets.clear();
+            for (const std::string &target : split(value))
+                options->targets.push_back(std::stod(target));
+        } else return false;
+    }
+    return true;
+}
+
+void write_reports(const Options &options, const std::vector<Run> &runs) {
+    std::ofstream events(options.output_dir / "events.csv");
+    events << "family,instance,algorithm,seed,time,evaluations,value,optimum,gap" << std::endl;
+    for (const Run &run : runs) {
+        for (const ProgressEvent &event : run.events) {
+            events << run.family << "," << run.instance << "," << run.algorithm << "," << run.seed << ","
+                   << event.time << "," << event.evaluations << "," << event.value << ","
+                   << run.optimum << "," << gap(event.value, run.optimum) << std::endl;
+        }
+    }
+
+    // time to target: runs that never reach a target are censored at the time limit
+    typedef std::pair<std::string, std::string> Group;  // (family, algorithm)
+    std::map<Group, std::map<double, std::vector<double>>> reached_times;
+    std::map<Group, size_t> group_runs;
+
+    std::ofstream ttt(options.output_dir / "ttt.csv");
+    ttt << "family,instance,algorithm,seed,target_gap,reached,time,evaluations" << std::endl;
+    for (const Run &run : runs) {
+        Group group(run.family, run.algorithm);
+        group_runs[group]++;
+
+        for (double target : options.targets) {
+            auto event = std::find_if(run.events.begin(), run.events.end(), [&](const ProgressEvent &e) {
+                return gap(e.value, run.optimum) <= target;
+            });
+            bool reached = event != run.events.end();
+
+            ttt << run.family << "," << run.instance << "," << run.algorithm << "," << run.seed << ","
+                << target << "," << reached << ",";
+            if (reached) {
+                ttt << event->time << "," << event->evaluations << std::endl;
+                reached_times[group][target].push_back(event->time);
+            } else {
+                ttt << "," << std::endl;
+            }
+        }
+    }
+
+    // empirical distribution: the i-th fastest of the runs has probability (i + 1/2) / runs
+    std::ofstream cdf(options.output_dir / "ttt_cdf.csv");
+    cdf << "family,algorithm,target_gap,time,probability" << std::endl;
+    for (auto &[group, by_target] : reached_times) {
+        for (auto &[target, times] : by_target) {
+            std::sort(times.begin(), times.end());
+            for (size_t i = 0; i < times.size(); i++) {
+                cdf << group.first << "," << group.second << "," << target << "," << times[i] << ","
+                    << (i + 0.5) / group_runs[group] << std::endl;
+            }
+        }
+    }
+
+    // anytime curves: the gap of each run's best value at log-spaced times; 1 before its first event
+    std::vector<double> checkpoints;
+    for (int k = 0; ; k++) {
+        double t = FIRST_CHECKPOINT * std::pow(10.0, (double) k / CHECKPOINTS_PER_DECADE);
+        if (t > options.time) break;
+        checkpoints.push_back(t);
+    }
+    checkpoints.push_back(options.time);
+
+    std::ofstream anytime(options.output_dir / "anytime.csv");
+    anytime << "family,algorithm,time,mean_gap,max_gap,runs" << std::endl;
+    std::map<Group, std::vector<const Run*>> grouped;
+    for (const Run &run : runs)
+        grouped[Group(run.family, run.algorithm)].push_back(&run);
+
+    for (const auto &[group, group_members] : grouped) {
+        for (double t : checkpoints) {
+            double sum = 0, worst = 0;
+            for (const Run *run : group_members) {
+                double g = 1;
+                for (const ProgressEvent &event : run->events) {
+                    if (event.time > t) break;
+                    g = gap(event.value, run->optimum);
+                }
+                sum += g;
+                worst = std::max(worst, g);
+            }
+            anytime << group.first << "," << group.second << "," << t << ","
+                    << sum / group_members.size() << "," << worst << "," << group_members.size() << std::endl;
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    Options options;
+    if (!parse_options(argc, argv, &options)) {
+        std::cerr << "Usage: " << argv[0] << " <output_dir> [--families low_dimensional,large_scale] [--algorithms grasp,sa,hc,rdm]"
+                  << " [--seeds N] [--time SECONDS] [--targets 0.05,0.01,0.001,0]" << std::endl;
+        return 2;
+    }
+    std::filesystem::create_directories(options.output_dir);
+
+    std::ostream discard(nullptr);
+    std::vector<Run> runs;
+    for (const std::string &family : options.families) {
+        std::filesystem::path instance_dir = std::filesystem::path("tests") / ("instances-" + family);
+        std::filesystem::path optimum_dir = std::filesystem::path("tests") / ("optimum-" + family);
+
+        std::vector<std::filesystem::path> instances;
+        for (const auto &entry : std::filesystem::directory_iterator(instance_dir)) {
+            if (entry.is_regular_file())
+                instances.push_back(entry.path());
+        }
+        std::sort(instances.begin(), instances.end());
+
+        for (const auto &path : instances) {
+            std::string name = path.filename().string();
+
+            long long optimum = -1;
+            std::ifstream optimum_file(optimum_dir / name);
+            if (optimum_file.is_open())
+                optimum_file >> optimum;
+            if (optimum <= 0) {
+                std::cerr << "Skipping " << name << ": no optimum" << std::endl;
+                continue;
+            }
+
+            KnapsackInstance *instance;
+            try {
+                instance = KnapsackInstance::load(path.string());
+            } catch (const std::exception &e) {
+                std::cerr << "Skipping " << name << ": " << e.what() << std::endl;
+                continue;
+            }
+            KnapsackEvaluator evl(instance);
+
+            for (const std::string &algorithm : options.algorithms) {
+                for (int seed = 1; seed <= options.seeds; seed++) {
+                    ProgressRecorder recorder;
+                    Budget budget(options.time);
+                    budget.set_recorder(&recorder);
+                    Random rng(seed);
+
+                    delete run_algorithm(algorithm, &evl, &budget, &rng, &discard);
+
+                    runs.push_back({ family, name, algorithm, (uint64_t) seed, optimum, recorder.get_events() });
+                    std::cout << family << " " << name << " " << algorithm << " seed " << seed << ": "
+                              << recorder.get_best() << " / " << optimum << " after " << budget.elapsed() << " s" << std::endl;
+                }
+            }
+
+            delete instance;
+        }
+    }
+
+    write_reports(options, runs);
+    return 0;
+}
@@ -0,0 +1,277 @@
+// Runs every (instance, algorithm, seed) job of one or more instance directories on a bounded set of workers.
+// Each job logs to its own file in the output directory; summary.csv collects one line per job, and
+// statistics.csv (also printed) aggregates the seeds of each (instance, algorithm) as independent replicates.
+// Build from 04-10/: make batch_runner
+// Usage: batch_runner <instance_dir[,instance_dir...]> <output_dir> [--optimum-dir DIR] [--algorithms grasp,sa,pt,hc,rdm]
+//     [--seeds N] [--time SECONDS] [--evaluations N] [--workers N] [--pin]
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <algorithm>
+#include <iomanip>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <pthread.h>
+#include <sched.h>
+#include "knapsack.h"
+#include "configurations.h"
+
+struct Job {
+    std::filesystem::path instance;
+    std::string algorithm;
+    uint64_t seed;
+};
+
+struct JobResult {
+    long long value;
+    double time;
+    long long evaluations;
+    std::string error;  // empty if the job finished
+};
+
+struct Options {
+    std::vector<std::filesystem::path> instance_dirs;
+    std::filesystem::path output_dir, optimum_dir;
+    std::vector<std::string> algorithms = { "grasp", "sa" };
+    int seeds = 1;
+    double time = 600;
+    long long evaluations = -1;
+    unsigned workers = std::max(1u, std::thread::hardware_concurrency());
+    bool pin = false;
+};
+
+// Directory and file name of an instance, so that equally named files of different directories stay apart.
+std::string instance_label(const std::filesystem::path &instance) {
+    return instance.parent_path().filename().string() + "/" + instance.filename().string();
+}
+
+JobResult run_job(const Job &job, const Options &options) {
+    std::string log_name = job.instance.parent_path().filename().string() + "." + job.instance.filename().string();
+    std::filesystem::path log_path = options.output_dir / (log_name + "." + job.algorithm + "." + std::to_string(job.seed) + ".txt");
+    std::ofstream log(log_path);
+
+    JobResult result = { KnapsackEvaluator::PUNISHMENT, 0, 0, "" };
+    try {
+        std::unique_ptr<KnapsackInstance> instance(KnapsackInstance::load(job.instance.string()));
+        KnapsackEvaluator evl(instance.get());
+        Random rng(job.seed);
+        Budget budget(options.time, options.evaluations);
+
+        KnapsackSolution *s = run_algorithm(job.algorithm, &evl, &budget, &rng, &log);
+        result.value = evl.get_evaluation(s);
+        result.time = budget.elapsed();
+        result.evaluations = budget.get_evaluations();
+
+        log << "Evaluation: " << result.value << " / ";
+        for (size_t i = 0; i < s->size(); i++) {
+            if (s->get(i))
+                log << i << " ";
+        }
+        log << std::endl;
+
+        delete s;
+    } catch (const std::exception &e) {
+        result.error = e.what();
+        log << "Error: " << e.what() << std::endl;
+    }
+
+    return result;
+}
+
+void pin_to_cpu(unsigned cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+// Without --optimum-dir, the optima of tests/instances-<family> are looked up in tests/optimum-<family>.
+long long read_optimum(const Options &options, const std::filesystem::path &instance) {
+    std::filesystem::path optimum_dir = options.optimum_dir;
+    if (optimum_dir.empty()) {
+        std::string family = instance.parent_path().filename().string();
+        if (family.rfind("instances-", 0) != 0) return -1;
+        optimum_dir = instance.parent_path().parent_path() / ("optimum-" + family.substr(std::string("instances-").size()));
+    }
+
+    std::ifstream optimum_file(optimum_dir / instance.filename());
+    long long optimum = -1;
+    if (optimum_file.is_open())
+        optimum_file >> optimum;
+    return optimum;
+}
+
+// q-quantile of sorted values, interpolating between neighbors
+double quantile(const std::vector<double> &sorted, double q) {
+    if (sorted.empty()) return 0;
+    double position = q * (sorted.size() - 1);
+    size_t k = (size_t) position;
+    if (k + 1 >= sorted.size()) return sorted.back();
+    return sorted[k] + (position - k) * (sorted[k + 1] - sorted[k]);
+}
+
+void write_statistics(const Options &options, const std::vector<Job> &jobs, const std::vector<JobResult> &results) {
+    // jobs of one (instance, algorithm) are its replicates; failed jobs are counted but not aggregated
+    typedef std::pair<std::string, std::string> Key;
+    std::map<Key, std::vector<size_t>> replicates;
+    std::map<Key, std::filesystem::path> paths;
+    for (size_t j = 0; j < jobs.size(); j++) {
+        Key key(instance_label(jobs[j].instance), jobs[j].algorithm);
+        replicates[key].push_back(j);
+        paths[key] = jobs[j].instance;
+    }
+
+    std::ofstream statistics(options.output_dir / "statistics.csv");
+    statistics << "instance,algorithm,replicates,failed,optimum,mean,median,best,worst,stddev,mean_gap,time_p10,time_p50,time_p90,time_max" << std::endl;
+
+    std::cout << std::endl << std::left << std::setw(48) << "instance" << std::setw(8) << "algo" << std::right
+              << std::setw(6) << "runs" << std::setw(14) << "optimum" << std::setw(14) << "mean" << std::setw(14) << "median"
+              << std::setw(14) << "best" << std::setw(12) << "stddev" << std::setw(10) << "gap %"
+              << std::setw(10) << "t50 s" << std::setw(10) << "t90 s" << std::endl;
+
+    for (const auto &[key, indices] : replicates) {
+        std::vector<double> values, times;
+        for (size_t j : indices) {
+            if (!results[j].error.empty()) continue;
+            values.push_back((double) results[j].value);
+            times.push_back(results[j].time);
+        }
+        std::sort(values.begin(), values.end());
+        std::sort(times.begin(), times.end());
+        size_t failed = indices.size() - values.size();
+        long long optimum = read_optimum(options, paths[key]);
+
+        double mean = 0, variance = 0;
+        for (double x : values) mean += x;
+        if (!values.empty()) mean /= values.size();
+        for (double x : values) variance += (x - mean) * (x - mean);
+        double stddev = (values.size() > 1) ? std::sqrt(variance / (values.size() - 1)) : 0;  // sample standard deviation
+        double median = quantile(values, 0.5);
+        double best = values.empty() ? 0 : values.back(), worst = values.empty() ? 0 : values.front();
+        double mean_gap = (optimum > 0) ? (optimum - mean) / optimum * 100 : -1;
+
+        statistics << key.first << "," << key.second << "," << values.size() << "," << failed << "," << optimum << ","
+                   << mean << "," << median << "," << best << "," << worst << "," << stddev << "," << mean_gap << ","
+                   << quantile(times, 0.1) << "," << quantile(times, 0.5) << "," << quantile(times, 0.9) << ","
+                   << (times.empty() ? 0 : times.back()) << std::endl;
+
+        std::cout << std::left << std::setw(48) << key.first << std::setw(8) << key.second << std::right << std::fixed
+                  << std::setw(6) << values.size() << std::setw(14) << optimum << std::setprecision(1)
+                  << std::setw(14) << mean << std::setw(14) << median << std::setprecision(0) << std::setw(14) << best
+                  << std::setprecision(2) << std::setw(12) << stddev << std::setw(10) << mean_gap
+                  << std::setprecision(3) << std::setw(10) << quantile(times, 0.5) << std::setw(10) << quantile(times, 0.9)
+                  << std::defaultfloat << std::endl;
+    }
+}
+
+bool parse_options(int argc, char **argv, Options *options) {
+    if (argc < 3) return false;
+    std::stringstream dirs(argv[1]);
+    std::string dir;
+    while (std::getline(dirs, dir, ','))
+        options->instance_dirs.push_back(dir);
+    options->output_dir = argv[2];
+
+    for (int i = 3; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--pin") {
+            options->pin = true;
+            continue;
+        }
+        if (i + 1 >= argc) return false;
+
+        std::string value = argv[++i];
+        if (arg == "--optimum-dir") options->optimum_dir = value;
+        else if (arg == "--seeds") options->seeds = std::stoi(value);
+        else if (arg == "--time") options->time = std::stod(value);
+        else if (arg == "--evaluations") options->evaluations = std::stoll(value);
+        else if (arg == "--workers") options->workers = std::max(1, std::stoi(value));
+        else if (arg == "--algorithms") {
+            options->algorithms.clear();
+            std::stringstream list(value);
+            std::string name;
+            while (std::getline(list, name, ',')) {
+                if (!is_algorithm(name)) {
+                    std::cerr << "Unknown algorithm '" << name << "'" << std::endl;
+                    return false;
+                }
+                options->algorithms.push_back(name);
+            }
+        } else return false;
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    Options options;
+    if (!parse_options(argc, argv, &options)) {
+        std::cerr << "Usage: " << argv[0] << " <instance_dir[,instance_dir...]> <output_dir> [--optimum-dir DIR] [--algorithms grasp,sa,pt,hc,rdm]"
+                  << " [--seeds N] [--time SECONDS] [--evaluations N] [--workers N] [--pin]" << std::endl;
+        return 2;
+    }
+    std::filesystem::create_directories(options.output_dir);
+
+    // largest instances first, so that the last jobs to start are the short ones
+    std::vector<std::filesystem::path> instances;
+    for (const auto &instance_dir : options.instance_dirs) {
+        for (const auto &entry : std::filesystem::directory_iterator(instance_dir)) {
+            if (entry.is_regular_file())
+                instances.push_back(entry.path());
+        }
+    }
+    std::sort(instances.begin(), instances.end(), [](const std::filesystem::path &a, const std::filesystem::path &b) {
+        return std::filesystem::file_size(a) > std::filesystem::file_size(b);
+    });
+
+    std::vector<Job> jobs;
+    for (const auto &instance : instances) {
+        for (const std::string &algorithm : options.algorithms) {
+            for (int seed = 1; seed <= options.seeds; seed++)
+                jobs.push_back({ instance, algorithm, (uint64_t) seed });
+        }
+    }
+
+    std::vector<JobResult> results(jobs.size());
+    std::atomic<size_t> next_job(0);
+    std::mutex progress_mutex;
+    size_t finished = 0;
+
+    unsigned cpus = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<std::thread> workers;
+    for (unsigned k = 0; k < options.workers; k++) {
+        workers.emplace_back([&, k]() {
+            if (options.pin) pin_to_cpu(k % cpus);
+
+            size_t j;
+            while ((j = next_job.fetch_add(1)) < jobs.size()) {
+                results[j] = run_job(jobs[j], options);
+
+                std::lock_guard<std::mutex> lock(progress_mutex);
+                std::cout << "[" << ++finished << "/" << jobs.size() << "] " << instance_label(jobs[j].instance)
+                          << " " << jobs[j].algorithm << " seed " << jobs[j].seed << ": "
+                          << (results[j].error.empty() ? std::to_string(results[j].value) : results[j].error) << std::endl;
+            }
+        });
+    }
+    for (std::thread &worker : workers)
+        worker.join();
+
+    std::ofstream summary(options.output_dir / "summary.csv");
+    summary << "instance,algorithm,seed,value,optimum,time,evaluations,error" << std::endl;
+    for (size_t j = 0; j < jobs.size(); j++) {
+        summary << instance_label(jobs[j].instance) << "," << jobs[j].algorithm << "," << jobs[j].seed << ","
+                << results[j].value << "," << read_optimum(options, jobs[j].instance) << ","
+                << results[j].time << "," << results[j].evaluations << "," << results[j].error << std::endl;
+    }
+
+    write_statistics(options, jobs, results);
+
+    return 0;
+}
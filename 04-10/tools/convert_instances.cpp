@@ -0,0 +1,50 @@
+// Converts every text instance of a directory to the binary format (see KnapsackBinaryHeader).
+// Build from 04-10/: make convert_instances
+// Usage: convert_instances <input_dir> <output_dir> [auto|separated|interleaved]
+#include <iostream>
+#include <filesystem>
+#include <string>
+#include "knapsack_instance.h"
+
+int main(int argc, char **argv) {
+    if (argc < 3 || argc > 4) {
+        std::cerr << "Usage: " << argv[0] << " <input_dir> <output_dir> [auto|separated|interleaved]" << std::endl;
+        return 2;
+    }
+
+    InstanceFormat format = InstanceFormat::AUTO;
+    if (argc == 4) {
+        std::string name = argv[3];
+        if (name == "separated") format = InstanceFormat::SEPARATED;
+        else if (name == "interleaved") format = InstanceFormat::INTERLEAVED;
+        else if (name != "auto") {
+            std::cerr << "Unknown format: " << name << std::endl;
+            return 2;
+        }
+    }
+
+    std::filesystem::path output_dir = argv[2];
+    std::filesystem::create_directories(output_dir);
+
+    int converted = 0, failed = 0;
+    for (const auto &entry : std::filesystem::directory_iterator(argv[1])) {
+        if (!entry.is_regular_file()) continue;
+
+        std::filesystem::path output = output_dir / entry.path().filename();
+        try {
+            KnapsackInstance *instance = KnapsackInstance::load(entry.path().string(), format);
+            instance->save(output.string());
+            delete instance;
+
+            // read it back, so a converted file is known to be valid
+            delete KnapsackInstance::load(output.string(), InstanceFormat::BINARY, true);
+            converted++;
+        } catch (const std::exception &e) {
+            std::cerr << "Skipping " << entry.path().string() << ": " << e.what() << std::endl;
+            failed++;
+        }
+    }
+
+    std::cout << converted << " instances converted, " << failed << " failed." << std::endl;
+    return (failed == 0) ? 0 : 1;
+}
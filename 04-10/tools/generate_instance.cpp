@@ -0,0 +1,189 @@
+// Generates Pisinger-style instances, named like the knapPI files: knapPI_<type>_<n>_<R>_<seed>.
+//   type 1, uncorrelated:         w and v uniform in [1, R]
+//   type 2, weakly correlated:    w uniform in [1, R], v uniform in [w - R/10, w + R/10], at least 1
+//   type 3, strongly correlated:  w uniform in [1, R], v = w + R/10
+// The capacity is max(sum(w) / 101, max(w)), as in the first instance of each bundled series.
+// Items are never held in memory: weights and value noise come from two random streams that are
+// replayed once per pass (capacity, values, weights), so 10^7 items need no more than the output buffer.
+// Build from 04-10/: make generate_instance
+// Usage: generate_instance <type> <n> <R> <seed> <output_dir> [--format separated|interleaved|binary]
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <charconv>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdint>
+#include "knapsack_instance.h"
+#include "random.h"
+
+// Replays the items of an instance in order.
+class ItemStream {
+private:
+    int type;
+    long long R;
+    Random weights, noise;
+public:
+    ItemStream(int type, long long R, uint64_t seed)
+        : type(type), R(R), weights(seed, 0), noise(seed, 1) {}
+
+    void next(int *v, int *w) {
+        *w = 1 + (int) this->weights.uniform_int(this->R);
+
+        if (this->type == 1) {
+            *v = 1 + (int) this->noise.uniform_int(this->R);
+        } else if (this->type == 2) {
+            long long spread = this->R / 10;
+            *v = (int) std::max(1LL, *w - spread + (long long) this->noise.uniform_int(2 * spread + 1));
+        } else {
+            *v = *w + (int) (this->R / 10);
+        }
+    }
+};
+
+// Buffered writer of decimal numbers and raw int32 arrays.
+class Output {
+private:
+    static const size_t BUFFER_SIZE = 1 << 20;
+    std::ofstream file;
+    std::vector<char> buffer;
+    size_t used;
+public:
+    Output(const std::string &path) : file(path, std::ios::binary | std::ios::trunc), buffer(BUFFER_SIZE), used(0) {
+        if (!this->file.is_open())
+            throw std::runtime_error("Cannot create '" + path + "'");
+    }
+
+    ~Output() {
+        this->flush();
+    }
+
+    void flush() {
+        this->file.write(this->buffer.data(), this->used);
+        this->used = 0;
+    }
+
+    void bytes(const void *data, size_t size) {
+        if (this->used + size > BUFFER_SIZE) this->flush();
+        std::memcpy(this->buffer.data() + this->used, data, size);
+        this->used += size;
+    }
+
+    void number(long long x, char separator) {
+        if (this->used + 24 > BUFFER_SIZE) this->flush();
+        char *end = std::to_chars(this->buffer.data() + this->used, this->buffer.data() + BUFFER_SIZE, x).ptr;
+        *end++ = separator;
+        this->used = end - this->buffer.data();
+    }
+
+    void patch(size_t offset, const void *data, size_t size) {
+        this->flush();
+        std::streampos position = this->file.tellp();
+        this->file.seekp(offset);
+        this->file.write((const char*) data, size);
+        this->file.seekp(position);
+    }
+
+    bool good() {
+        this->flush();
+        return this->file.good();
+    }
+};
+
+int main(int argc, char **argv) {
+    if (argc != 6 && argc != 8) {
+        std::cerr << "Usage: " << argv[0] << " <type> <n> <R> <seed> <output_dir> [--format separated|interleaved|binary]" << std::endl;
+        return 2;
+    }
+
+    int type = std::stoi(argv[1]);
+    long long n = std::stoll(argv[2]), R = std::stoll(argv[3]);
+    uint64_t seed = std::stoull(argv[4]);
+    std::string format = (argc == 8) ? argv[7] : "separated";
+
+    if (type < 1 || type > 3 || n < 0 || n > INT32_MAX || R < 1 || R > INT32_MAX / 2) {
+        std::cerr << "Invalid parameters: type must be 1, 2 or 3, n non-negative and R positive." << std::endl;
+        return 2;
+    }
+    if (argc == 8 && (std::string(argv[6]) != "--format" || (format != "separated" && format != "interleaved" && format != "binary"))) {
+        std::cerr << "Unknown format option." << std::endl;
+        return 2;
+    }
+
+    std::filesystem::create_directories(argv[5]);
+    std::filesystem::path path = std::filesystem::path(argv[5]) /
+        ("knapPI_" + std::to_string(type) + "_" + std::to_string(n) + "_" + std::to_string(R) + "_" + std::to_string(seed));
+
+    // first pass: the capacity depends on every weight
+    long long sum_w = 0, max_w = 0;
+    {
+        ItemStream items(type, R, seed);
+        for (long long i = 0; i < n; i++) {
+            int v, w;
+            items.next(&v, &w);
+            sum_w += w;
+            max_w = std::max(max_w, (long long) w);
+        }
+    }
+    long long q = std::max(sum_w / 101, max_w);
+
+    try {
+        Output out(path.string());
+
+        if (format == "interleaved") {
+            out.number(n, ' ');
+            out.number(q, '\n');
+            ItemStream items(type, R, seed);
+            for (long long i = 0; i < n; i++) {
+                int v, w;
+                items.next(&v, &w);
+                out.number(v, ' ');
+                out.number(w, '\n');
+            }
+        } else if (format == "separated") {
+            out.number(n, ' ');
+            out.number(q, '\n');
+            for (int pass = 0; pass < 2; pass++) {
+                ItemStream items(type, R, seed);
+                for (long long i = 0; i < n; i++) {
+                    int v, w;
+                    items.next(&v, &w);
+                    out.number(pass == 0 ? v : w, (i + 1 == n) ? '\n' : ' ');
+                }
+            }
+        } else {
+            // the checksum is only known at the end, the header is written again once it is
+            KnapsackBinaryHeader header = KnapsackBinaryHeader::layout(n, q, KnapsackBinaryHeader::CHECKSUM_BASIS);
+            out.bytes(&header, sizeof(header));
+
+            for (int pass = 0; pass < 2; pass++) {
+                if (pass == 1) {
+                    const char zeros[KnapsackBinaryHeader::ALIGNMENT] = {};
+                    out.bytes(zeros, header.padding());
+                }
+
+                ItemStream items(type, R, seed);
+                for (long long i = 0; i < n; i++) {
+                    int v, w;
+                    items.next(&v, &w);
+                    int32_t x = (pass == 0) ? v : w;
+                    header.checksum = KnapsackBinaryHeader::checksum_step(header.checksum, x);
+                    out.bytes(&x, sizeof(x));
+                }
+            }
+            out.patch(0, &header, sizeof(header));
+        }
+
+        if (!out.good())
+            throw std::runtime_error("Cannot write '" + path.string() + "'");
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    std::cout << path.string() << std::endl;
+    return 0;
+}
@@ -0,0 +1,45 @@
+// Converts a trace written by TraceWriter to CSV on stdout.
+// Build from 04-10/: make trace_to_csv
+// Usage: trace_to_csv <trace_file>
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include "trace.h"
+
+int main(int argc, char **argv) {
+    if (argc != 2) {
+        std::cerr << "Usage: " << argv[0] << " <trace_file>" << std::endl;
+        return 2;
+    }
+
+    std::ifstream file(argv[1], std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Cannot open '" << argv[1] << "'" << std::endl;
+        return 1;
+    }
+
+    TraceFileHeader header;
+    if (!file.read((char*) &header, sizeof(header)) || std::memcmp(header.magic, TraceFileHeader::MAGIC, sizeof(header.magic)) != 0) {
+        std::cerr << "'" << argv[1] << "' is not a trace file" << std::endl;
+        return 1;
+    }
+    if (header.version != TraceFileHeader::VERSION || header.record_size != sizeof(TraceRecord)) {
+        std::cerr << "Unsupported trace version " << header.version << std::endl;
+        return 1;
+    }
+    if (header.dropped > 0)
+        std::cerr << header.dropped << " records were dropped while tracing" << std::endl;
+
+    std::cout << "kind,iteration,time,current,best,temperature,improved" << std::endl;
+    TraceRecord r;
+    while (file.read((char*) &r, sizeof(r))) {
+        const char *kind = (r.kind == (uint32_t) TraceKind::SA_STEP) ? "sa"
+                         : (r.kind == (uint32_t) TraceKind::GRASP_ITERATION) ? "grasp" : "?";
+        std::cout << kind << "," << r.iteration << "," << r.time << "," << r.current << ","
+                  << r.best << "," << r.temperature << "," << r.improved << "\n";
+    }
+    if (file.gcount() != 0)
+        std::cerr << "Ignoring a truncated record at the end of the file" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,82 @@
+#include "trace.h"
+#include <stdexcept>
+#include <cstring>
+#include <algorithm>
+
+#define DRAIN_BATCH 1024
+#define DRAIN_IDLE std::chrono::milliseconds(1)
+
+TraceRing::TraceRing(size_t capacity)
+    : head(0), cached_tail(0), tail(0), cached_head(0)
+{
+    size_t size = 1;
+    while (size < capacity) size *= 2;
+    this->records.resize(size);
+    this->mask = size - 1;
+}
+
+size_t TraceRing::pop(TraceRecord *out, size_t max) {
+    size_t t = this->tail.load(std::memory_order_relaxed);
+    if (this->cached_head == t)
+        this->cached_head = this->head.load(std::memory_order_acquire);
+
+    size_t count = std::min(max, this->cached_head - t);
+    for (size_t k = 0; k < count; k++)
+        out[k] = this->records[(t + k) & this->mask];
+
+    this->tail.store(t + count, std::memory_order_release);
+    return count;
+}
+
+TraceWriter::TraceWriter(const std::string &path, TraceSampling sampling, size_t capacity)
+    : sampling(sampling), ring(capacity), file(path, std::ios::binary | std::ios::trunc), stopping(false), dropped(0)
+{
+    if (!this->file.is_open())
+        throw std::runtime_error("Cannot create '" + path + "'");
+
+    TraceFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, TraceFileHeader::MAGIC, sizeof(header.magic));
+    header.version = TraceFileHeader::VERSION;
+    header.record_size = sizeof(TraceRecord);
+    this->file.write((const char*) &header, sizeof(header));
+
+    this->start = clock::now();
+    this->drainer = std::thread([this]() { this->drain(); });
+}
+
+TraceWriter::~TraceWriter() {
+    this->close();
+}
+
+void TraceWriter::drain() {
+    std::vector<TraceRecord> batch(DRAIN_BATCH);
+    while (true) {
+        // read the flag first: once it is set, a pop that comes back empty is final
+        bool last = this->stopping.load(std::memory_order_acquire);
+        size_t count = this->ring.pop(batch.data(), batch.size());
+
+        if (count > 0)
+            this->file.write((const char*) batch.data(), count * sizeof(TraceRecord));
+        else if (last)
+            return;
+        else
+            std::this_thread::sleep_for(DRAIN_IDLE);
+    }
+}
+
+void TraceWriter::close() {
+    if (!this->drainer.joinable()) return;
+
+    this->stopping.store(true, std::memory_order_release);
+    this->drainer.join();
+
+    uint64_t dropped = this->dropped;
+    this->file.seekp(offsetof(TraceFileHeader, dropped));
+    this->file.write((const char*) &dropped, sizeof(dropped));
+    this->file.close();
+}
+
+unsigned long long TraceWriter::get_dropped() const {
+    return this->dropped;
+}
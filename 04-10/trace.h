@@ -0,0 +1,91 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <fstream>
+#include <string>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+enum class TraceKind : uint32_t {
+    SA_STEP = 1,         // one sampled movement of simulated annealing
+    GRASP_ITERATION = 2  // one construction plus local search
+};
+
+// One fixed-size record of a trace file, in native byte order.
+struct TraceRecord {
+    double time;  // seconds since the writer was opened
+    int64_t iteration;
+    int64_t current;  // s_curr for SA, the value of the iteration's solution for GRASP
+    int64_t best;  // s_prime
+    double temperature;  // 0 outside SA
+    uint32_t kind;  // TraceKind
+    uint32_t improved;  // 1 if best was raised by this iteration
+};
+static_assert(sizeof(TraceRecord) == 48, "trace records are written as raw bytes");
+
+// Trace files are this header followed by TraceRecords up to the end of the file.
+struct TraceFileHeader {
+    static constexpr char MAGIC[8] = { 'K', 'N', 'A', 'P', 'T', 'R', 'C', '\0' };
+    static const uint32_t VERSION = 1;
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;
+    uint64_t dropped;  // records lost because the ring was full, written on close
+};
+
+// Which iterations are recorded: every 'every'-th one (none if 0), and those that improve the best value.
+struct TraceSampling {
+    long long every = 1000;
+    bool on_improvement = true;
+};
+
+// Single-producer single-consumer ring of records. The capacity is a power of two, so positions
+// only grow and are masked on access; each side caches the other's position and only reloads it
+// when the ring looks full (or empty), so pushes usually touch no shared cache line.
+class TraceRing {
+private:
+    std::vector<TraceRecord> records;
+    size_t mask;
+    alignas(64) std::atomic<size_t> head;  // next position written, owned by the producer
+    size_t cached_tail;
+    alignas(64) std::atomic<size_t> tail;  // next position read, owned by the consumer
+    size_t cached_head;
+public:
+    TraceRing(size_t capacity);  // rounded up to a power of two
+    TraceRing(const TraceRing&) = delete;
+    TraceRing& operator=(const TraceRing&) = delete;
+    inline bool push(const TraceRecord &record);  // false if full
+    size_t pop(TraceRecord *out, size_t max);
+};
+
+// Trace sink for one search thread. record() applies the sampling and pushes into the ring
+// without blocking or allocating; a background thread drains the ring to the file. A full ring
+// drops the record rather than stall the search, and the loss is counted in the file header.
+class TraceWriter {
+private:
+    typedef std::chrono::steady_clock clock;
+    TraceSampling sampling;
+    TraceRing ring;
+    std::ofstream file;
+    std::thread drainer;
+    std::atomic<bool> stopping;
+    clock::time_point start;
+    unsigned long long dropped;
+    void drain();
+public:
+    TraceWriter(const std::string &path, TraceSampling sampling = TraceSampling(), size_t capacity = 1 << 16);
+    TraceWriter(const TraceWriter&) = delete;
+    TraceWriter& operator=(const TraceWriter&) = delete;
+    ~TraceWriter();  // closes
+    inline void record(TraceKind kind, long long iteration, long long current, long long best, double temperature, bool improved);
+    void close();  // drains what is left and completes the header
+    unsigned long long get_dropped() const;
+};
+
+#include "trace.tpp"
+
+#endif // TRACE_H
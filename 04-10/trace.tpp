@@ -0,0 +1,31 @@
+#include "trace.h"
+
+inline bool TraceRing::push(const TraceRecord &record) {
+    size_t h = this->head.load(std::memory_order_relaxed);
+    if (h - this->cached_tail > this->mask) {
+        this->cached_tail = this->tail.load(std::memory_order_acquire);
+        if (h - this->cached_tail > this->mask) return false;
+    }
+
+    this->records[h & this->mask] = record;
+    this->head.store(h + 1, std::memory_order_release);
+    return true;
+}
+
+inline void TraceWriter::record(TraceKind kind, long long iteration, long long current, long long best, double temperature, bool improved) {
+    bool sampled = (this->sampling.on_improvement && improved)
+        || (this->sampling.every > 0 && iteration % this->sampling.every == 0);
+    if (!sampled) return;
+
+    TraceRecord r;
+    r.time = std::chrono::duration<double>(clock::now() - this->start).count();
+    r.iteration = iteration;
+    r.current = current;
+    r.best = best;
+    r.temperature = temperature;
+    r.kind = (uint32_t) kind;
+    r.improved = improved;
+
+    if (!this->ring.push(r))
+        this->dropped++;
+}